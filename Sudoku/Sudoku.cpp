@@ -3,8 +3,27 @@
 
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <cerrno>
+#include <cstdlib>
 
 #include "SudokuGrid.h"
+#include "SudokuArchive.h"
+#include "SudokuBatch.h"
+#include "SudokuBoard.h"
+#include "SudokuConstraints.h"
+#include "SudokuBench.h"
+#include "SudokuGenerator.h"
+#include "SudokuSampler.h"
+#include "SudokuRater.h"
+#include "SudokuSamurai.h"
+
+#include <chrono>
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 using namespace std;
 
@@ -14,13 +33,158 @@ static void show_usage(std::string name)
 		<< "Options:\n"
 		<< "\t-h,--help\t\tPrints usage\n"
 		<< "\t-s,--solve filename\tSpecify the Sudoku puzzle to be solved\n"
-		<< "\t-g n ,--generate n\tGenerate a Sudoku puzzle of difficulty level 'n' (0=easy, 1=medium, 2=hard, 3=samurai)"
+		<< "\t-v,--variant filename\tConstraints of the variant solved by --solve, one per line: 'diagonals', 'anti-knight', 'anti-king',\n"
+		<< "\t\t\t\t'unit r1c1 r2c2 ...' (cells with different values) or 'cage 15 r1c1 r1c2 ...' (and adding up to 15)\n"
+		<< "\t--samurai filename\tSolve a Samurai puzzle (five overlapping grids), written as 21 lines of 21 characters\n"
+		<< "\t--samurai-generate\tGenerate Samurai puzzles with a single solution, as many as --count (1 by default) written to --output\n"
+		<< "\t-b,--batch [filename]\tSolve all the puzzles of a file (or stdin), one 81 characters line per puzzle (files may also hold 9 lines per puzzle)\n"
+		<< "\t--size n\t\tSize of the boards of --batch: 4, 9 (default), 16 or 25, values written '1'-'9' and then 'A', 'B'...\n"
+		<< "\t\t\t\tOther sizes than 9 only take --threads, not --lockstep, --engine, --logic, --binary or --cache\n"
+		<< "\t--lockstep\t\tSolve the puzzles of --batch in groups of 16 propagated together, only the ones that stall are searched\n"
+		<< "\t--cache n\t\tKeep the solutions of the last 'n' puzzles of --batch, so that puzzles equivalent to them (same puzzle up to\n"
+		<< "\t\t\t\tsymmetries and relabelling of the values) are not solved again\n"
+		<< "\t-t,--threads n\t\tNumber of threads used by --batch, --solve and --count (0 = all the cores, 1 by default, at most " << POOL_MAX_THREADS << ")\n"
+		<< "\t-e,--engine name\tBrute force engine used by --solve: 'backtrack' (default) or 'dlx' (Dancing Links)\n"
+		<< "\t-l,--logic list\t\tTechniques used by --solve and --batch before searching: 'none' (default), 'all' or a comma separated list of\n"
+		<< "\t\t\t\tnaked-pairs, hidden-pairs, naked-triples, hidden-triples, naked-quads, hidden-quads, xwing, swordfish\n"
+		<< "\t--bench [filename]\tBenchmark the solver and the generator, writing the results as JSON to a file ('-' for stdout)\n"
+		<< "\t-g n ,--generate n\tGenerate a Sudoku puzzle of difficulty level 'n' (0=easy, 1=medium, 2=hard, 3=samurai)\n"
+		<< "\t-n,--count n\t\tNumber of puzzles generated by --generate, one 81 characters line per puzzle (uses --threads)\n"
+		<< "\t--sample n\t\tGenerate 'n' random solved grids, one 81 characters line per grid\n"
+		<< "\t-o,--output filename\tFile where the puzzles generated by --count or --sample are written (stdout by default)\n"
+		<< "\t-m,--mask name\t\tClues of the puzzles generated by --count: 'level' (the fixed mask of the level, default), 'symmetric' or 'random'\n"
+		<< "\t--clues n\t\tClues kept by --mask symmetric or random (by default, as many as in the mask of the level)\n"
+		<< "\t--min-score n\t\tGenerate again the puzzles of --count with a difficulty score below 'n' (see --rate), up to " << GENERATOR_MAX_ATTEMPTS << " attempts:\n"
+		<< "\t\t\t\tthe last attempt is written even when still below and the run then fails\n"
+		<< "\t-r,--rate [filename]\tRate the difficulty of all the puzzles of a file (or stdin), one 81 characters line per puzzle\n"
+		<< "\t--binary\t\tWrite the output of --batch, --count and --sample as a binary archive, 3 to 4 times smaller than text\n"
+		<< "\t--to-binary filename\tConvert a file of puzzles or solved grids into a binary archive written to --output\n"
+		<< "\t--to-text filename\tConvert a binary archive into text, one 81 characters line per grid, written to --output\n"
+		<< "\t--seed s\t\tSeed of the puzzles or grids generated, the same seed and level give the same puzzles (random by default)\n"
+		<< "\t--first k\t\tNumber of the first puzzle generated within the sequence of the seed (0 by default)"
 		<< std::endl;
 }
 
+/**
+ * Generates Samurai puzzles 'first' to 'first + nrofPuzzles - 1' of the sequence of 'seed', written as 21
+ * lines each followed by an empty line
+ */
+static int generate_samurai(const uint64_t seed, const uint64_t first, const uint64_t nrofPuzzles, const std::string &outputFile)
+{
+	std::ofstream file;
+
+	if (false == outputFile.empty()) {
+
+		file.open(outputFile);
+
+		if (false == file.is_open()) {
+
+			std::cerr << "Unable to open file " << outputFile << std::endl;
+			return 1;
+		}
+	}
+
+	std::ostream &out = file.is_open() ? file : std::cout;
+
+	CSudokuSamurai samurai;
+
+	for (uint64_t number = first; number < (first + nrofPuzzles); number++) {
+
+		const uint32_t nrofClues = samurai.generate(seed, number);
+
+		if (0 == nrofClues) {
+
+			std::cerr << "Unable to generate Samurai puzzle " << number << std::endl;
+			return 1;
+		}
+
+		samurai.print(out);
+		out << "\n";
+		std::cerr << "Samurai puzzle " << number << ": " << nrofClues << " clues" << std::endl;
+	}
+
+	out.flush();
+
+	return 0;
+}
+
+/**
+ * Reads the value of a numeric option, which must be made of digits only and not exceed 'max'
+ */
+static bool parse_number(const std::string &number, const uint64_t max, uint64_t &value)
+{
+	if (number.empty() || (std::string::npos != number.find_first_not_of("0123456789"))) {
+		return false;
+	}
+
+	errno = 0;
+	const unsigned long long result = std::strtoull(number.c_str(), nullptr, 10);
+
+	if ((ERANGE == errno) || (result > max)) {
+		return false;
+	}
+
+	value = result;
+	return true;
+}
+
+/**
+ * Reads the techniques of the --logic option ('none', 'all' or a comma separated list of names)
+ */
+static bool parse_logic(const std::string &list, uint32_t &logic)
+{
+	static const char *NAMES[] = {
+		"naked-pairs", "hidden-pairs", "naked-triples", "hidden-triples", "naked-quads", "hidden-quads", "xwing", "swordfish"
+	};
+
+	if (list == "none") {
+
+		logic = LOGIC_NONE;
+		return true;
+	}
+
+	if (list == "all") {
+
+		logic = LOGIC_ALL;
+		return true;
+	}
+
+	logic = LOGIC_NONE;
+
+	size_t start = 0;
+
+	while (start <= list.size()) {
+
+		size_t end = list.find(',', start);
+
+		if (std::string::npos == end) {
+			end = list.size();
+		}
+
+		const std::string name = list.substr(start, end - start);
+		uint32_t flag = 0;
+
+		for (uint32_t nameId = 0; nameId < sizeof(NAMES) / sizeof(NAMES[0]); nameId++) {
+
+			if (name == NAMES[nameId]) {
+				flag = 1 << nameId;
+			}
+		}
+
+		if (0 == flag) {
+			return false;
+		}
+
+		logic |= flag;
+		start = end + 1;
+	}
+
+	return true;
+}
+
 int main(int argc, char** argv)
 {
-	if ((argc < 3) || (argc > 5)) {
+	if (argc < 2) {
 
 		show_usage(argv[0]);
 		return 1;
@@ -28,6 +192,35 @@ int main(int argc, char** argv)
 
 	CSudokuGrid grid;
 
+	std::string solveFile;
+	std::string samuraiFile;
+	std::string variantFile;
+	bool samuraiGenerate = false;
+	std::string batchFile;
+	bool batch = false;
+	std::string benchFile;
+	bool bench = false;
+	std::string level;
+	std::string outputFile;
+	uint64_t nrofPuzzles = 0;
+	uint64_t nrofGrids = 0;
+	uint64_t first = 0;
+	std::string seed;
+	uint8_t mask = MASK_LEVEL;
+	uint32_t nrofClues = 0;
+	uint32_t minScore = 0;
+	std::string rateFile;
+	bool rate = false;
+	bool binary = false;
+	std::string toBinaryFile;
+	std::string toTextFile;
+	int engine = ENGINE_BACKTRACK;
+	uint32_t logic = LOGIC_NONE;
+	bool lockstep = false;
+	uint64_t cacheSize = 0;
+	uint32_t size = NROF_VALUES;
+	uint32_t nrofThreads = 1;
+
 	for (int i = 1; i < argc; ++i) {
 
 		std::string arg = argv[i];
@@ -41,56 +234,401 @@ int main(int argc, char** argv)
 
 			if (i + 1 < argc) {
 
-				const std::string filename = argv[++i];
+				// Solved once all the options are known
+				solveFile = argv[++i];
+			}
+			else {
 
-				if (grid.readGrid(filename))
-				{
-					uint32_t iter = 0;
+				std::cerr << "--solve option requires a filename." << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "-v") || (arg == "--variant")) {
 
-					grid.solve(iter);
+			if (i + 1 < argc) {
+				variantFile = argv[++i];
+			}
+			else {
 
-					std::cout << "Iterations: " << iter << std::endl;
-				}
-				else {
+				std::cerr << "--variant option requires a filename." << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--samurai") {
 
-					std::cerr << "Unable to open file" << std::endl;
-					return 1;
-				}
+			if (i + 1 < argc) {
+				samuraiFile = argv[++i];
 			}
 			else {
 
-				std::cerr << "--solve option requires a filename." << std::endl;
+				std::cerr << "--samurai option requires a filename." << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "--samurai-generate") {
+			samuraiGenerate = true;
+		}
+		else if ((arg == "-b") || (arg == "--batch")) {
+
+			batch = true;
+
+			// Standard input when no filename is given
+			if ((i + 1 < argc) && ('-' != argv[i + 1][0])) {
+				batchFile = argv[++i];
+			}
+		}
+		else if (arg == "--bench") {
+
+			bench = true;
+
+			// No JSON output when no filename is given
+			if ((i + 1 < argc) && (('-' != argv[i + 1][0]) || ('\0' == argv[i + 1][1]))) {
+				benchFile = argv[++i];
+			}
+		}
+		else if (arg == "--size") {
+
+			const std::string number = (i + 1 < argc) ? argv[++i] : "";
+
+			if ((number != "4") && (number != "9") && (number != "16") && (number != "25")) {
+
+				std::cerr << "--size option requires 4, 9, 16 or 25." << std::endl;
+				return 1;
+			}
+
+			size = (uint32_t)std::stoul(number);
+		}
+		else if (arg == "--lockstep") {
+			lockstep = true;
+		}
+		else if (arg == "--cache") {
+
+			const std::string number = (i + 1 < argc) ? argv[++i] : "";
+
+			if (false == parse_number(number, UINT64_MAX, cacheSize)) {
+
+				std::cerr << "--cache option requires a number of puzzles." << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "-t") || (arg == "--threads")) {
+
+			const std::string number = (i + 1 < argc) ? argv[++i] : "";
+
+			uint64_t value = 0;
+
+			if (false == parse_number(number, POOL_MAX_THREADS, value)) {
+
+				std::cerr << "--threads option requires a number of threads, at most " << POOL_MAX_THREADS << "." << std::endl;
+				return 1;
+			}
+
+			nrofThreads = (uint32_t)value;
+
+			if (0 == nrofThreads) {
+				nrofThreads = CSudokuPool::hardwareThreads();
+			}
+		}
+		else if ((arg == "-e") || (arg == "--engine")) {
+
+			const std::string name = (i + 1 < argc) ? argv[++i] : "";
+
+			if (name == "backtrack") {
+				engine = ENGINE_BACKTRACK;
+			}
+			else if (name == "dlx") {
+				engine = ENGINE_DLX;
+			}
+			else {
+
+				std::cerr << "--engine option requires 'backtrack' or 'dlx'." << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "-l") || (arg == "--logic")) {
+
+			const std::string list = (i + 1 < argc) ? argv[++i] : "";
+
+			if (false == parse_logic(list, logic)) {
+
+				std::cerr << "--logic option requires 'none', 'all' or a comma separated list of techniques." << std::endl;
 				return 1;
 			}
 		}
 		else if ((arg == "-g") || (arg == "--generate")) {
 
+			level = (i + 1 < argc) ? argv[++i] : "";
+
+			if ((level != "0") && (level != "1") && (level != "2") && (level != "3")) {
+
+				std::cerr << "--generate option requires a difficulty level from 0 to 3 (0=easy, 1=medium, 2=hard, 3=samurai)." << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "-n") || (arg == "--count")) {
+
+			const std::string number = (i + 1 < argc) ? argv[++i] : "";
+
+			if (false == parse_number(number, UINT64_MAX, nrofPuzzles)) {
+
+				std::cerr << "--count option requires a number of puzzles." << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "-m") || (arg == "--mask")) {
+
+			const std::string name = (i + 1 < argc) ? argv[++i] : "";
+
+			if (name == "level") {
+				mask = MASK_LEVEL;
+			}
+			else if (name == "symmetric") {
+				mask = MASK_SYMMETRIC;
+			}
+			else if (name == "random") {
+				mask = MASK_RANDOM;
+			}
+			else {
+
+				std::cerr << "--mask option requires 'level', 'symmetric' or 'random'." << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "--clues") || (arg == "--min-score")) {
+
+			const std::string number = (i + 1 < argc) ? argv[++i] : "";
+
+			uint64_t value = 0;
+
+			if (false == parse_number(number, UINT32_MAX, value)) {
+
+				std::cerr << arg << " option requires a number." << std::endl;
+				return 1;
+			}
+
+			((arg == "--clues") ? nrofClues : minScore) = (uint32_t)value;
+		}
+		else if ((arg == "-r") || (arg == "--rate")) {
+
+			rate = true;
+
+			// Standard input when no filename is given
+			if ((i + 1 < argc) && ('-' != argv[i + 1][0])) {
+				rateFile = argv[++i];
+			}
+		}
+		else if (arg == "--binary") {
+			binary = true;
+		}
+		else if ((arg == "--to-binary") || (arg == "--to-text")) {
+
 			if (i + 1 < argc) {
+				((arg == "--to-binary") ? toBinaryFile : toTextFile) = argv[++i];
+			}
+			else {
+
+				std::cerr << arg << " option requires a filename." << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "--seed") || (arg == "--first")) {
+
+			const std::string number = (i + 1 < argc) ? argv[++i] : "";
 
-				const std::string level = argv[++i];
+			uint64_t value = 0;
 
-				if ((level != "0") && (level != "1") && (level != "2") && (level != "3")) {
+			if (false == parse_number(number, UINT64_MAX, value)) {
 
-					std::cerr << "--generate option requires a difficulty level from 0 to 3 (0=easy, 1=medium, 2=hard, 3=samurai)." << std::endl;
-					return 1;
-				}
+				std::cerr << arg << " option requires a number from 0 to " << UINT64_MAX << "." << std::endl;
+				return 1;
+			}
 
-				std::cout << "Generating Sudoku level " << level << "" << std::endl;
+			if (arg == "--seed") {
+				seed = number;
+			}
+			else {
+				first = value;
+			}
+		}
+		else if (arg == "--sample") {
 
-				int result = 0;
+			const std::string number = (i + 1 < argc) ? argv[++i] : "";
 
-				result = grid.generate((uint8_t)std::stoi(level));
+			if (false == parse_number(number, UINT64_MAX, nrofGrids)) {
 
-				//std::cout << "Result: " << result << std::endl;
+				std::cerr << "--sample option requires a number of grids." << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "-o") || (arg == "--output")) {
+
+			if (i + 1 < argc) {
+				outputFile = argv[++i];
 			}
 			else {
 
-				std::cerr << "--generate option requires a difficulty level from 0 to 3 (0=easy, 1=medium, 2=hard, 3=samurai)." << std::endl;
+				std::cerr << "--output option requires a filename." << std::endl;
 				return 1;
 			}
 		}
 	}
 
+	// Boards of other sizes are only solved by --batch, with their own solver (see CSudokuBoard)
+	if (NROF_VALUES != size) {
+
+		if (false == batch) {
+
+			std::cerr << "--size option requires --batch." << std::endl;
+			return 1;
+		}
+
+		if (lockstep || binary || cacheSize || (ENGINE_BACKTRACK != engine) || (LOGIC_NONE != logic)) {
+
+			std::cerr << "--lockstep, --engine, --logic, --binary and --cache options require --size 9." << std::endl;
+			return 1;
+		}
+	}
+
+	// A random seed is printed so that the puzzles can be generated again
+	if (((false == level.empty()) || nrofGrids || samuraiGenerate) && seed.empty()) {
+
+		seed = std::to_string((uint64_t)std::chrono::system_clock::now().time_since_epoch().count());
+		std::cerr << "Seed: " << seed << std::endl;
+	}
+
+#if defined(_WIN32)
+	// Archives written to the standard output must not get their end of line bytes translated
+	if (binary || (false == toBinaryFile.empty())) {
+		_setmode(_fileno(stdout), _O_BINARY);
+	}
+
+	// Archives read from the standard input must not get their bytes translated either (see CSudokuCorpus::read)
+	_setmode(_fileno(stdin), _O_BINARY);
+#endif
+
+	if (false == toBinaryFile.empty()) {
+		return CSudokuArchive::toBinary(toBinaryFile, outputFile);
+	}
+
+	if (false == toTextFile.empty()) {
+		return CSudokuArchive::toText(toTextFile, outputFile);
+	}
+
+	if (samuraiGenerate) {
+		return generate_samurai(std::stoull(seed), first, nrofPuzzles ? nrofPuzzles : 1, outputFile);
+	}
+
+	if (false == samuraiFile.empty()) {
+
+		CSudokuSamurai samurai;
+
+		if (false == samurai.readGrid(samuraiFile)) {
+
+			std::cerr << "Unable to open file" << std::endl;
+			return 1;
+		}
+
+		searchStats_t stats;
+		const int retVal = samurai.solve(stats);
+
+		samurai.print();
+
+		std::cout << ((VALID_SOLVED == retVal) ? "Solved" : "No solution") << std::endl;
+		std::cout << "Iterations: " << stats.iter << std::endl;
+		std::cout << "Branches: " << stats.branches << " (backtracks: " << stats.backtracks << ", depth: " << stats.maxDepth << ", trail: " << stats.maxTrailDepth << ")" << std::endl;
+
+		return (VALID_SOLVED == retVal) ? 0 : 1;
+	}
+
+	if (nrofGrids) {
+
+		CSudokuSampler sampler(std::stoull(seed));
+		sampler.setBinary(binary);
+
+		return sampler.run(nrofGrids, outputFile);
+	}
+
+	if (false == level.empty()) {
+
+		if (nrofPuzzles) {
+
+			CSudokuGenerator generator((uint8_t)std::stoi(level), std::stoull(seed), nrofThreads, mask, nrofClues, minScore);
+			generator.setBinary(binary);
+
+			return generator.run(first, nrofPuzzles, outputFile);
+		}
+
+		std::cout << "Generating Sudoku level " << level << "" << std::endl;
+
+		grid.generate((uint8_t)std::stoi(level), std::stoull(seed), first);
+	}
+
+	if (rate) {
+
+		CSudokuRater rater;
+		return rater.run(rateFile);
+	}
+
+	if (bench) {
+
+		CSudokuBench benchmark;
+		return benchmark.run(benchFile);
+	}
+
+	if (batch && (NROF_VALUES != size)) {
+
+		switch (size) {
+
+		case 4:
+			return CSudokuBoard<2>::run(batchFile, nrofThreads);
+
+		case 16:
+			return CSudokuBoard<4>::run(batchFile, nrofThreads);
+
+		default:
+			return CSudokuBoard<5>::run(batchFile, nrofThreads);
+		}
+	}
+
+	if (batch) {
+
+		CSudokuBatch solver(engine, nrofThreads, logic, lockstep);
+		CSudokuCache cache((size_t)cacheSize);
+
+		solver.setBinary(binary);
+		solver.setCache(cacheSize ? &cache : nullptr);
+
+		return solver.run(batchFile);
+	}
+
+	if (false == solveFile.empty()) {
+
+		CSudokuConstraints constraints;
+
+		if ((false == variantFile.empty()) && (false == constraints.read(variantFile))) {
+			return 1;
+		}
+
+		// The constraints need to be known when the clues are read
+		grid.setConstraints(&constraints);
+
+		if (grid.readGrid(solveFile))
+		{
+			searchStats_t stats;
+
+			grid.setLogic(logic);
+			grid.solve(stats, true, engine, nrofThreads);
+
+			std::cout << "Iterations: " << stats.iter << std::endl;
+			std::cout << "Branches: " << stats.branches << " (backtracks: " << stats.backtracks << ", depth: " << stats.maxDepth << ", trail: " << stats.maxTrailDepth << ")" << std::endl;
+		}
+		else {
+
+			std::cerr << "Unable to open file" << std::endl;
+			return 1;
+		}
+	}
+
 	return 0;
 }
 
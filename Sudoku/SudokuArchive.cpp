@@ -0,0 +1,449 @@
+#include "SudokuArchive.h"
+#include "SudokuCorpus.h"
+
+#include <iostream>
+#include <cstring>
+
+using namespace std;
+
+// Number of permutations of the values left after each position of a row, from the first one
+static const uint32_t FACTORIALS[NROF_COLS] = { 40320, 5040, 720, 120, 24, 6, 2, 1, 1 };
+
+CSudokuArchive::CSudokuArchive()
+	: m_out(nullptr), m_kind(ARCHIVE_PUZZLES), m_nrofRecords(0), m_checksum(0)
+{
+}
+
+CSudokuArchive::~CSudokuArchive()
+{
+	if (nullptr != m_out) {
+		close();
+	}
+}
+
+/**
+ * Starts an archive of puzzles or of solved grids (ARCHIVE_PUZZLES or ARCHIVE_SOLUTIONS), writing its header
+ */
+bool CSudokuArchive::create(FILE *out, const uint8_t kind)
+{
+	assert(out);
+	assert((ARCHIVE_PUZZLES == kind) || (ARCHIVE_SOLUTIONS == kind));
+
+	m_out = out;
+	m_kind = kind;
+	m_nrofRecords = 0;
+	m_checksum = checksum(nullptr, 0);
+
+	m_buffer.clear();
+	m_buffer.reserve(ARCHIVE_BUFFER_SIZE + ARCHIVE_MAX_PUZZLE_SIZE);
+
+	const uint8_t header[ARCHIVE_HEADER_SIZE] = {
+		(uint8_t)ARCHIVE_MAGIC, (uint8_t)(ARCHIVE_MAGIC >> 8), (uint8_t)(ARCHIVE_MAGIC >> 16), (uint8_t)(ARCHIVE_MAGIC >> 24),
+		ARCHIVE_VERSION, kind, 0, 0
+	};
+
+	return (ARCHIVE_HEADER_SIZE == fwrite(header, 1, ARCHIVE_HEADER_SIZE, m_out));
+}
+
+/**
+ * Appends a grid in line format (81 characters). A solved grid that cannot be encoded is written as not solved
+ */
+void CSudokuArchive::write(const char *line)
+{
+	assert(m_out);
+
+	uint8_t record[ARCHIVE_MAX_PUZZLE_SIZE];
+	uint32_t size = ARCHIVE_SOLUTION_SIZE;
+
+	if (ARCHIVE_PUZZLES == m_kind) {
+		size = encodePuzzle(line, record);
+	}
+	else if (false == encodeSolution(line, record)) {
+
+		memset(record, 0, ARCHIVE_SOLUTION_SIZE);
+
+		for (uint32_t bitId = 0; bitId < ARCHIVE_RANK_BITS; bitId++) {
+			record[bitId / 8] |= (uint8_t)(1 << (bitId % 8));
+		}
+	}
+
+	m_buffer.insert(m_buffer.end(), record, record + size);
+	m_nrofRecords++;
+
+	if (m_buffer.size() >= ARCHIVE_BUFFER_SIZE) {
+		flush();
+	}
+}
+
+/**
+ * Appends the grids of a block of lines, 81 characters and the end of line each
+ */
+void CSudokuArchive::writeLines(const char *lines, const uint32_t nrofLines)
+{
+	for (uint32_t lineId = 0; lineId < nrofLines; lineId++) {
+		write(lines + lineId * (NROF_ROWS * NROF_COLS + 1));
+	}
+}
+
+/**
+ * Writes the records left and the trailer
+ */
+bool CSudokuArchive::close()
+{
+	assert(m_out);
+
+	flush();
+
+	uint8_t trailer[ARCHIVE_TRAILER_SIZE];
+
+	for (uint32_t byteId = 0; byteId < 8; byteId++) {
+		trailer[byteId] = (uint8_t)(m_nrofRecords >> (8 * byteId));
+	}
+
+	for (uint32_t byteId = 0; byteId < 4; byteId++) {
+		trailer[8 + byteId] = (uint8_t)(m_checksum >> (8 * byteId));
+	}
+
+	fwrite(trailer, 1, ARCHIVE_TRAILER_SIZE, m_out);
+	fflush(m_out);
+
+	const bool success = (0 == ferror(m_out));
+	m_out = nullptr;
+
+	return success;
+}
+
+void CSudokuArchive::flush()
+{
+	m_checksum = checksum(m_buffer.data(), m_buffer.size(), m_checksum);
+
+	fwrite(m_buffer.data(), 1, m_buffer.size(), m_out);
+	m_buffer.clear();
+}
+
+/**
+ * Encodes a puzzle in line format ('1'-'9' for a clue, any other character for an empty cell), returning the size of the record
+ */
+uint32_t CSudokuArchive::encodePuzzle(const char *line, uint8_t *record)
+{
+	memset(record, 0, ARCHIVE_MAX_PUZZLE_SIZE);
+
+	uint32_t nrofClues = 0;
+
+	for (uint32_t cellId = 0; cellId < (NROF_ROWS * NROF_COLS); cellId++) {
+
+		// '1' = 49, '9' = 57
+		if ((line[cellId] < 49) || (line[cellId] > 57)) {
+			continue;
+		}
+
+		record[cellId / 8] |= (uint8_t)(1 << (cellId % 8));
+		record[ARCHIVE_MASK_SIZE + nrofClues / 2] |= (uint8_t)((line[cellId] - 48) << (4 * (nrofClues % 2)));
+		nrofClues++;
+	}
+
+	return ARCHIVE_MASK_SIZE + (nrofClues + 1) / 2;
+}
+
+/**
+ * Decodes a puzzle record into a line ('.' for empty cells), returning its size or 0 when it is truncated or corrupted
+ */
+uint32_t CSudokuArchive::decodePuzzle(const uint8_t *record, const size_t size, char *line)
+{
+	if (size < ARCHIVE_MASK_SIZE) {
+		return 0;
+	}
+
+	uint32_t nrofClues = 0;
+
+	for (uint32_t byteId = 0; byteId < ARCHIVE_MASK_SIZE; byteId++) {
+		nrofClues += bitCount(record[byteId]);
+	}
+
+	const uint32_t recordSize = ARCHIVE_MASK_SIZE + (nrofClues + 1) / 2;
+
+	// Bits past the last cell are never set
+	if ((record[ARCHIVE_MASK_SIZE - 1] >> ((NROF_ROWS * NROF_COLS) % 8)) || (size < recordSize)) {
+		return 0;
+	}
+
+	uint32_t clueId = 0;
+
+	for (uint32_t cellId = 0; cellId < (NROF_ROWS * NROF_COLS); cellId++) {
+
+		if (0 == (record[cellId / 8] & (1 << (cellId % 8)))) {
+
+			line[cellId] = 46; // '.' = 46
+			continue;
+		}
+
+		const uint32_t value = (record[ARCHIVE_MASK_SIZE + clueId / 2] >> (4 * (clueId % 2))) & 0x0F;
+		clueId++;
+
+		if ((0 == value) || (value > NROF_VALUES)) {
+			return 0;
+		}
+
+		line[cellId] = (char)(48 + value); // '0' = 48
+	}
+
+	return recordSize;
+}
+
+/**
+ * Encodes a solved grid in line format. Fails unless every row and column holds every value once
+ */
+bool CSudokuArchive::encodeSolution(const char *line, uint8_t *record)
+{
+	uint16_t colMask[NROF_COLS] = { 0 };
+	uint64_t bits = 0;
+	uint32_t nrofBits = 0;
+	uint32_t byteId = 0;
+
+	for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		const char *row = line + rowId * NROF_COLS;
+		uint16_t rowMask = 0;
+		uint32_t rank = 0;
+
+		for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+
+			// '1' = 49, '9' = 57
+			if ((row[colId] < 49) || (row[colId] > 57)) {
+				return false;
+			}
+
+			const uint16_t bit = valToBit(row[colId]);
+
+			if ((rowMask & bit) || (colMask[colId] & bit)) {
+				return false;
+			}
+
+			rowMask |= bit;
+			colMask[colId] |= bit;
+
+			// Values after this one in the row that are lower
+			rank += FACTORIALS[colId] * bitCount(~rowMask & (bit - 1));
+		}
+
+		if ((NROF_ROWS - 1) == rowId) {
+			break;
+		}
+
+		bits |= (uint64_t)rank << nrofBits;
+		nrofBits += ARCHIVE_RANK_BITS;
+
+		for (; nrofBits >= 8; nrofBits -= 8) {
+
+			record[byteId++] = (uint8_t)bits;
+			bits >>= 8;
+		}
+	}
+
+	if (nrofBits) {
+		record[byteId] = (uint8_t)bits;
+	}
+
+	return true;
+}
+
+/**
+ * Decodes a solution record into a line ('.' for every cell of a grid that was not solved). Fails when the record is corrupted
+ */
+bool CSudokuArchive::decodeSolution(const uint8_t *record, char *line)
+{
+	uint16_t colMask[NROF_COLS] = { 0 };
+	uint64_t bits = 0;
+	uint32_t nrofBits = 0;
+	uint32_t byteId = 0;
+
+	for (uint32_t rowId = 0; rowId < (NROF_ROWS - 1); rowId++) {
+
+		for (; nrofBits < ARCHIVE_RANK_BITS; nrofBits += 8) {
+			bits |= (uint64_t)record[byteId++] << nrofBits;
+		}
+
+		uint32_t rank = (uint32_t)(bits & ARCHIVE_NO_SOLUTION);
+
+		bits >>= ARCHIVE_RANK_BITS;
+		nrofBits -= ARCHIVE_RANK_BITS;
+
+		if ((0 == rowId) && (ARCHIVE_NO_SOLUTION == rank)) {
+
+			memset(line, 46, NROF_ROWS * NROF_COLS); // '.' = 46
+			return true;
+		}
+
+		if (rank >= (FACTORIALS[0] * NROF_COLS)) {
+			return false;
+		}
+
+		uint16_t left = ALL_CANDIDATES;
+
+		for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+
+			uint32_t index = rank / FACTORIALS[colId];
+			rank %= FACTORIALS[colId];
+
+			// The 'index'-th lowest value still left
+			uint16_t bit = left;
+
+			for (; index; index--) {
+				bit &= (bit - 1);
+			}
+
+			bit &= -bit;
+			left &= ~bit;
+
+			if (colMask[colId] & bit) {
+				return false;
+			}
+
+			colMask[colId] |= bit;
+			line[rowId * NROF_COLS + colId] = bitToVal(bit);
+		}
+	}
+
+	// Every value is missing from a single column
+	for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+		line[(NROF_ROWS - 1) * NROF_COLS + colId] = bitToVal(ALL_CANDIDATES & ~colMask[colId]);
+	}
+
+	return true;
+}
+
+/**
+ * Whether a block of bytes starts like an archive, with the magic of the header
+ */
+bool CSudokuArchive::isArchive(const uint8_t *data, const size_t size)
+{
+	return (size >= 4) && (ARCHIVE_MAGIC == (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24)));
+}
+
+/**
+ * FNV-1a hash of a block of bytes, going on from the hash of the previous ones
+ */
+uint32_t CSudokuArchive::checksum(const uint8_t *data, const size_t size, uint32_t hash)
+{
+	for (size_t byteId = 0; byteId < size; byteId++) {
+
+		hash ^= data[byteId];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/**
+ * Converts a file of puzzles or solved grids in text (see CSudokuCorpus) into an archive ('-' or empty name
+ * for the standard output). The archive holds solutions when every grid is solved, puzzles otherwise
+ */
+int CSudokuArchive::toBinary(const std::string &inFile, const std::string &outFile)
+{
+	CSudokuCorpus corpus;
+
+	if (false == corpus.open(inFile)) {
+		return 1;
+	}
+
+	uint8_t kind = ARCHIVE_SOLUTIONS;
+	uint64_t nrofRecords = 0;
+	uint8_t record[ARCHIVE_MAX_PUZZLE_SIZE];
+	const char *cells;
+
+	while (corpus.next(cells)) {
+
+		if ((nullptr == cells) || (false == encodeSolution(cells, record))) {
+			kind = ARCHIVE_PUZZLES;
+		}
+
+		nrofRecords++;
+	}
+
+	if (0 == nrofRecords) {
+		kind = ARCHIVE_PUZZLES;
+	}
+
+	FILE *out = (outFile.empty() || ("-" == outFile)) ? stdout : fopen(outFile.c_str(), "wb");
+
+	if (nullptr == out) {
+
+		std::cerr << "Unable to open file " << outFile << std::endl;
+		return 1;
+	}
+
+	CSudokuArchive archive;
+	bool success = archive.create(out, kind);
+
+	// Records too short are kept as empty puzzles
+	char empty[NROF_ROWS * NROF_COLS];
+	memset(empty, 46, NROF_ROWS * NROF_COLS); // '.' = 46
+
+	for (corpus.rewind(); corpus.next(cells); ) {
+		archive.write(cells ? cells : empty);
+	}
+
+	success = archive.close() && success;
+
+	if (stdout != out) {
+		fclose(out);
+	}
+
+	std::cerr << "Wrote " << nrofRecords << ((ARCHIVE_SOLUTIONS == kind) ? " solutions" : " puzzles") << std::endl;
+
+	return success ? 0 : 1;
+}
+
+/**
+ * Converts an archive (or any file read by CSudokuCorpus) into text, one 81 characters line per grid
+ */
+int CSudokuArchive::toText(const std::string &inFile, const std::string &outFile)
+{
+	CSudokuCorpus corpus;
+
+	if (false == corpus.open(inFile)) {
+		return 1;
+	}
+
+	FILE *out = (outFile.empty() || ("-" == outFile)) ? stdout : fopen(outFile.c_str(), "wb");
+
+	if (nullptr == out) {
+
+		std::cerr << "Unable to open file " << outFile << std::endl;
+		return 1;
+	}
+
+	std::vector<char> buffer;
+	buffer.reserve(ARCHIVE_BUFFER_SIZE + NROF_ROWS * NROF_COLS + 1);
+
+	const char *cells;
+
+	while (corpus.next(cells)) {
+
+		if (cells) {
+			buffer.insert(buffer.end(), cells, cells + NROF_ROWS * NROF_COLS);
+		}
+		else {
+			buffer.resize(buffer.size() + NROF_ROWS * NROF_COLS, 46); // '.' = 46
+		}
+
+		buffer.push_back('\n');
+
+		if (buffer.size() >= ARCHIVE_BUFFER_SIZE) {
+
+			fwrite(buffer.data(), 1, buffer.size(), out);
+			buffer.clear();
+		}
+	}
+
+	fwrite(buffer.data(), 1, buffer.size(), out);
+	fflush(out);
+
+	const bool success = (0 == ferror(out)) && corpus.isComplete();
+
+	if (stdout != out) {
+		fclose(out);
+	}
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "SudokuGrid.h"
+
+
+// First bytes of an archive: 'S' = 83, 'D' = 68, 'K' = 75, 'B' = 66
+#define ARCHIVE_MAGIC ((uint32_t)0x42444B53)
+#define ARCHIVE_VERSION (1)
+
+// Kinds of records held by an archive
+enum { ARCHIVE_PUZZLES = 0, ARCHIVE_SOLUTIONS = 1 };
+
+// Header: magic, version, kind of records and two reserved bytes. Trailer: number of records (64 bits) and checksum of the records
+#define ARCHIVE_HEADER_SIZE (8)
+#define ARCHIVE_TRAILER_SIZE (12)
+
+// Puzzle record: a bit per cell set for the clues, then the clues 4 bits each ('1' = 1 to '9' = 9), low bits first
+#define ARCHIVE_MASK_SIZE ((NROF_ROWS * NROF_COLS + 7) / 8)
+#define ARCHIVE_MAX_PUZZLE_SIZE (ARCHIVE_MASK_SIZE + (NROF_ROWS * NROF_COLS + 1) / 2)
+
+// Solution record: the index of the permutation of each row but the last one, 19 bits each
+#define ARCHIVE_RANK_BITS (19)
+#define ARCHIVE_SOLUTION_SIZE (((NROF_ROWS - 1) * ARCHIVE_RANK_BITS + 7) / 8)
+
+// Index of the first row of a solution record for a grid that was not solved
+#define ARCHIVE_NO_SOLUTION ((uint32_t)((1 << ARCHIVE_RANK_BITS) - 1))
+
+// Size of the blocks written to the output
+#define ARCHIVE_BUFFER_SIZE (1 << 20)
+
+
+/**
+ * Binary archive of puzzles or solved grids, 3 to 4 times smaller than the same grids in text.
+ *
+ * The records follow an 8 bytes header and are closed by a trailer with their number and a checksum of
+ * their bytes (FNV-1a), all numbers little endian:
+ *
+ * - Puzzles take 11 bytes for the mask of the clues and 4 bits per clue, 24 bytes for 25 clues.
+ * - Solved grids take 19 bytes: a row of a solved grid is a permutation of the values, stored as its
+ *   index among the 9! permutations (Lehmer code), and the last row is the only one that completes the
+ *   columns. Grids that were not solved are written with ARCHIVE_NO_SOLUTION as first index.
+ *
+ * The writer takes grids in line format (see CSudokuGrid::writeLine). Archives are read through
+ * CSudokuCorpus, like text files, and the converters turn text files into archives and back.
+ */
+class CSudokuArchive
+{
+public:
+	CSudokuArchive();
+	~CSudokuArchive();
+
+	bool create(FILE *out, const uint8_t kind);
+	void write(const char *line);
+	void writeLines(const char *lines, const uint32_t nrofLines);
+	bool close();
+
+	static uint32_t encodePuzzle(const char *line, uint8_t *record);
+	static uint32_t decodePuzzle(const uint8_t *record, const size_t size, char *line);
+	static bool encodeSolution(const char *line, uint8_t *record);
+	static bool decodeSolution(const uint8_t *record, char *line);
+	static uint32_t checksum(const uint8_t *data, const size_t size, uint32_t hash = 2166136261u);
+	static bool isArchive(const uint8_t *data, const size_t size);
+
+	static int toBinary(const std::string &inFile, const std::string &outFile);
+	static int toText(const std::string &inFile, const std::string &outFile);
+
+private:
+	FILE *m_out;
+	uint8_t m_kind;
+
+	// Records not written yet, their number and the checksum of all of them
+	std::vector<uint8_t> m_buffer;
+	uint64_t m_nrofRecords;
+	uint32_t m_checksum;
+
+private:
+	void flush();
+};
@@ -0,0 +1,375 @@
+#include "SudokuBatch.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+CSudokuBatch::CSudokuBatch(const int engine, const uint32_t nrofThreads, const uint32_t logic, const bool lockstep)
+	: m_engine(engine), m_lockstep(lockstep), m_pool(nrofThreads), m_grids(m_pool.getNrofThreads()), m_lanes(lockstep ? m_pool.getNrofThreads() : 0),
+	m_reading(0), m_solving(nullptr), m_binary(false), m_cache(nullptr), m_nrofPuzzles(0), m_nrofSolved(0), m_nrofPropagated(0)
+{
+	for (CSudokuGrid &grid : m_grids) {
+		grid.setLogic(logic);
+	}
+
+	for (block_t &block : m_blocks) {
+
+		// Never reallocated, the puzzles of the block point to their copies
+		block.copies.reserve(BATCH_BLOCK_SIZE * NROF_ROWS * NROF_COLS);
+		block.puzzles.reserve(BATCH_BLOCK_SIZE);
+		block.first = 0;
+	}
+}
+
+CSudokuBatch::~CSudokuBatch()
+{
+}
+
+/**
+ * Solves all the puzzles of a file ('-' or empty name for the standard input), writing the solutions
+ * to the standard output
+ */
+int CSudokuBatch::run(const std::string &fileName)
+{
+	if (fileName.empty() || ("-" == fileName)) {
+		return run(stdin, stdout);
+	}
+
+	CSudokuCorpus corpus;
+
+	if (false == corpus.open(fileName)) {
+		return 1;
+	}
+
+	return run(corpus, stdout);
+}
+
+/**
+ * Writes the solutions as a binary archive (see CSudokuArchive) instead of text
+ */
+void CSudokuBatch::setBinary(const bool binary)
+{
+	m_binary = binary;
+}
+
+/**
+ * Looks up the puzzles in a cache of solutions before solving them, adding the new ones (nullptr for none)
+ */
+void CSudokuBatch::setCache(CSudokuCache *cache)
+{
+	m_cache = cache;
+
+	for (CSudokuGrid &grid : m_grids) {
+		grid.setCache(cache);
+	}
+}
+
+/**
+ * Solves the records of a stream as they are read, chunk by chunk (see CSudokuCorpus::stream), parsed like
+ * the ones of a file. The blocks of puzzles are solved as soon as they are full, or as soon as the stream
+ * has nothing more to read for now
+ */
+int CSudokuBatch::run(FILE *in, FILE *out)
+{
+	assert(in);
+	assert(out);
+
+	CSudokuCorpus corpus;
+
+	if (false == corpus.stream(in)) {
+		return 1;
+	}
+
+	return run(corpus, out);
+}
+
+/**
+ * Solves the records of a corpus in place, no puzzle is copied unless it is in grid format or read from a stream
+ */
+int CSudokuBatch::run(CSudokuCorpus &corpus, FILE *out)
+{
+	assert(out);
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if (m_binary) {
+		m_archive.create(out, ARCHIVE_SOLUTIONS);
+	}
+
+	const char *cells;
+
+	while (corpus.next(cells)) {
+
+		// Records in grid format share a buffer of the corpus
+		if (cells && (false == corpus.inPlace(cells))) {
+			copyPuzzle(cells, out);
+		}
+		else {
+			addPuzzle(cells, out);
+		}
+
+		// Nothing more to read from the stream for now, the solutions of the puzzles read so far are written
+		// before waiting for the next ones
+		if (corpus.isWaiting()) {
+
+			solveBlock(out);
+			flush(out);
+		}
+	}
+
+	solveBlock(out);
+	flush(out);
+
+	const bool success = ((false == m_binary) || m_archive.close()) && corpus.isComplete();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printSummary(seconds);
+
+	return success ? 0 : 1;
+}
+
+/**
+ * Copies a puzzle that does not stay in place to the current block, solving the block when it is full
+ */
+void CSudokuBatch::copyPuzzle(const char *cells, FILE *out)
+{
+	std::vector<char> &copies = m_blocks[m_reading].copies;
+	const char *puzzle = copies.data() + copies.size();
+
+	copies.insert(copies.end(), cells, cells + (NROF_ROWS * NROF_COLS));
+	addPuzzle(puzzle, out);
+}
+
+/**
+ * Appends a puzzle (null when invalid) to the current block, solving the block when it is full. The puzzle
+ * is not copied, it must stay in place until the block is solved
+ */
+void CSudokuBatch::addPuzzle(const char *puzzle, FILE *out)
+{
+	std::vector<const char *> &puzzles = m_blocks[m_reading].puzzles;
+
+	puzzles.push_back(puzzle);
+
+	if (BATCH_BLOCK_SIZE == puzzles.size()) {
+		solveBlock(out);
+	}
+}
+
+/**
+ * Starts solving the block just read in the background and writes the solutions of the previous one
+ * meanwhile. The next block is read into the buffers of the previous one
+ */
+void CSudokuBatch::solveBlock(FILE *out)
+{
+	block_t &block = m_blocks[m_reading];
+	const uint32_t nrofPuzzles = (uint32_t)block.puzzles.size();
+
+	if (0 == nrofPuzzles) {
+		return;
+	}
+
+	block_t *previous = m_solving;
+
+	if (previous) {
+		m_pool.wait();
+	}
+
+	block.results.resize(nrofPuzzles * (NROF_ROWS * NROF_COLS + 1));
+	block.solved.assign(nrofPuzzles, 0);
+	block.propagated.assign(nrofPuzzles, 0);
+	block.first = m_nrofPuzzles;
+
+	m_nrofPuzzles += nrofPuzzles;
+	m_latency.resize(m_nrofPuzzles);
+
+	m_solving = &block;
+
+	if (m_lockstep) {
+		m_pool.start((nrofPuzzles + LANES_WIDTH - 1) / LANES_WIDTH, [this](const uint32_t workerId, const uint32_t groupId) { solveLanes(workerId, groupId); }, BATCH_LANES_GRAIN);
+	}
+	else {
+		m_pool.start(nrofPuzzles, [this](const uint32_t workerId, const uint32_t puzzleId) { solvePuzzle(workerId, puzzleId); }, BATCH_GRAIN);
+	}
+
+	if (previous) {
+		writeBlock(*previous, out);
+	}
+
+	m_reading = 1 - m_reading;
+}
+
+/**
+ * Writes the solutions of a block in input order, leaving it empty for the next puzzles
+ */
+void CSudokuBatch::writeBlock(block_t &block, FILE *out)
+{
+	const uint32_t nrofPuzzles = (uint32_t)block.puzzles.size();
+
+	if (m_binary) {
+		m_archive.writeLines(block.results.data(), nrofPuzzles);
+	}
+	else {
+
+		fwrite(block.results.data(), 1, block.results.size(), out);
+		fflush(out);
+	}
+
+	for (uint32_t puzzleId = 0; puzzleId < nrofPuzzles; puzzleId++) {
+		m_nrofSolved += block.solved[puzzleId];
+		m_nrofPropagated += block.propagated[puzzleId];
+	}
+
+	block.puzzles.clear();
+	block.copies.clear();
+}
+
+/**
+ * Waits for the block being solved and writes its solutions
+ */
+void CSudokuBatch::flush(FILE *out)
+{
+	if (nullptr == m_solving) {
+		return;
+	}
+
+	m_pool.wait();
+	writeBlock(*m_solving, out);
+
+	m_solving = nullptr;
+}
+
+/**
+ * Solves a puzzle of the block being solved with the grid of the worker. Cells that could not be solved are written as '.'
+ */
+void CSudokuBatch::solvePuzzle(const uint32_t workerId, const uint32_t puzzleId)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	CSudokuGrid &grid = m_grids[workerId];
+	block_t &block = *m_solving;
+	char *result = &block.results[puzzleId * (NROF_ROWS * NROF_COLS + 1)];
+
+	if (block.puzzles[puzzleId] && grid.readLine(block.puzzles[puzzleId], NROF_ROWS * NROF_COLS)) {
+
+		searchStats_t stats;
+
+		block.solved[puzzleId] = (VALID_SOLVED == grid.solve(stats, false, m_engine));
+		grid.writeLine(result);
+	}
+	else {
+		memset(result, 46, NROF_ROWS * NROF_COLS); // '.' = 46
+	}
+
+	result[NROF_ROWS * NROF_COLS] = '\n';
+
+	m_latency[block.first + puzzleId] = (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Solves a group of LANES_WIDTH puzzles of the block being solved in lockstep. The puzzles that stall go on from
+ * their candidates with the grid of the worker, the ones with a conflict are solved again from the start so 
+ * that their output is the same as without lockstep. Every puzzle of the group is as late as the group
+ */
+void CSudokuBatch::solveLanes(const uint32_t workerId, const uint32_t groupId)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	CSudokuGrid &grid = m_grids[workerId];
+	CSudokuLanes &lanes = m_lanes[workerId];
+	block_t &block = *m_solving;
+
+	const uint32_t firstId = groupId * LANES_WIDTH;
+	const uint32_t nrofLanes = std::min<uint32_t>(LANES_WIDTH, (uint32_t)block.puzzles.size() - firstId);
+
+	for (uint32_t laneId = 0; laneId < LANES_WIDTH; laneId++) {
+		lanes.load(laneId, (laneId < nrofLanes) ? block.puzzles[firstId + laneId] : nullptr);
+	}
+
+	lanes.propagate();
+
+	for (uint32_t laneId = 0; laneId < nrofLanes; laneId++) {
+
+		const uint32_t puzzleId = firstId + laneId;
+		const char *puzzle = block.puzzles[puzzleId];
+		char *result = &block.results[puzzleId * (NROF_ROWS * NROF_COLS + 1)];
+
+		const int state = lanes.getState(laneId);
+
+		if (nullptr == puzzle) {
+			memset(result, 46, NROF_ROWS * NROF_COLS); // '.' = 46
+		}
+		else if (VALID_SOLVED == state) {
+
+			lanes.writeLine(laneId, result);
+
+			block.solved[puzzleId] = 1;
+			block.propagated[puzzleId] = 1;
+		}
+		else {
+
+			if (VALID_NOT_SOLVED == state) {
+
+				uint16_t cells[NROF_ROWS][NROF_COLS];
+
+				lanes.getCandidates(laneId, cells);
+				grid.readCandidates(cells);
+			}
+			else {
+				grid.readLine(puzzle, NROF_ROWS * NROF_COLS);
+			}
+
+			searchStats_t stats;
+
+			block.solved[puzzleId] = (VALID_SOLVED == grid.solve(stats, false, m_engine));
+			grid.writeLine(result);
+		}
+
+		result[NROF_ROWS * NROF_COLS] = '\n';
+	}
+
+	const uint32_t latency = (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	for (uint32_t laneId = 0; laneId < nrofLanes; laneId++) {
+		m_latency[block.first + firstId + laneId] = latency;
+	}
+}
+
+/**
+ * Prints on stderr the number of puzzles solved, the throughput and the mean and p99 latency per puzzle
+ */
+void CSudokuBatch::printSummary(const double seconds)
+{
+	double mean = 0;
+	double p99 = 0;
+
+	if (m_latency.size()) {
+
+		uint64_t total = 0;
+		for (std::vector<uint32_t>::iterator it = m_latency.begin(); it != m_latency.end(); ++it) {
+			total += *it;
+		}
+
+		mean = (double)total / m_latency.size();
+
+		std::vector<uint32_t>::iterator it99 = m_latency.begin() + (m_latency.size() * 99) / 100;
+		std::nth_element(m_latency.begin(), it99, m_latency.end());
+		p99 = *it99;
+	}
+
+	std::cerr << std::fixed << std::setprecision(1)
+		<< "Solved " << m_nrofSolved << " of " << m_nrofPuzzles << " puzzles in " << seconds << " s: "
+		<< ((seconds > 0) ? m_nrofPuzzles / seconds : 0) << " puzzles/s, "
+		<< "mean " << mean / 1000 << " us, p99 " << p99 / 1000 << " us" << std::endl;
+
+	if (m_lockstep) {
+		std::cerr << "Solved by lockstep propagation alone: " << m_nrofPropagated << " of " << m_nrofPuzzles << " puzzles" << std::endl;
+	}
+
+	if (m_cache) {
+		std::cerr << "Cache: " << m_cache->getHits() << " hits of " << m_cache->getLookups() << " lookups, " << m_cache->size() << " solutions kept" << std::endl;
+	}
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "SudokuArchive.h"
+#include "SudokuCache.h"
+#include "SudokuCorpus.h"
+#include "SudokuGrid.h"
+#include "SudokuLanes.h"
+#include "SudokuPool.h"
+
+
+// Puzzles solved together before their solutions are written, in input order
+#define BATCH_BLOCK_SIZE (1 << 16)
+
+// Puzzles taken at once by a worker from a block
+#define BATCH_GRAIN (64)
+
+// Groups of LANES_WIDTH puzzles taken at once by a worker from a block, in lockstep mode
+#define BATCH_LANES_GRAIN (4)
+
+
+/**
+ * Solves a stream of puzzles in line format (81 characters per line, see CSudokuGrid::readLine)
+ * writing one line with the solution for each of them. Throughput and latency figures are
+ * printed on stderr once the stream is over.
+ *
+ * Files are mapped in memory (see CSudokuCorpus), which also takes puzzles in grid format and archives,
+ * and the puzzles are solved straight from the mapping. The standard input is read by the corpus chunk
+ * by chunk and parsed exactly like a file, its puzzles copied into the current block. The solutions can also be written as a binary archive (see
+ * CSudokuArchive), grids that were not solved are then written as such.
+ *
+ * Puzzles are gathered in blocks that are solved by a pool of workers, each one with its own grid.
+ * The solutions of a block are written in the same order as the puzzles were read. A block is solved
+ * in the background while the next one is read and the solutions of the previous one are written. The advanced
+ * techniques in 'logic' (see CSudokuGrid::setLogic) are enabled on every grid.
+ *
+ * In lockstep mode the workers take groups of LANES_WIDTH puzzles and propagate them together (see
+ * CSudokuLanes). Only the puzzles that stall are finished by the grid of the worker.
+ *
+ * With a cache (see CSudokuCache), shared by all the workers, a puzzle equivalent to one solved before
+ * takes its solution from the cache.
+ */
+class CSudokuBatch
+{
+public:
+	CSudokuBatch(const int engine = ENGINE_BACKTRACK, const uint32_t nrofThreads = 1, const uint32_t logic = LOGIC_NONE, const bool lockstep = false);
+	~CSudokuBatch();
+
+	int run(const std::string &fileName);
+	int run(FILE *in, FILE *out);
+	int run(CSudokuCorpus &corpus, FILE *out);
+
+	void setBinary(const bool binary);
+	void setCache(CSudokuCache *cache);
+
+private:
+	int m_engine;
+	bool m_lockstep;
+
+	CSudokuPool m_pool;
+
+	// Grid of each worker, reused for every puzzle
+	std::vector<CSudokuGrid> m_grids;
+
+	// Lanes of each worker in lockstep mode
+	std::vector<CSudokuLanes> m_lanes;
+
+
+	typedef struct {
+		// Puzzles (81 characters each, null for an invalid record) and the copies of the ones that do not
+		// stay in place in the corpus
+		std::vector<const char *> puzzles;
+		std::vector<char> copies;
+
+		// Solutions (81 characters and end of line each), whether they were solved and, in lockstep mode,
+		// whether the propagation of the lanes was enough
+		std::vector<char> results;
+		std::vector<uint8_t> solved;
+		std::vector<uint8_t> propagated;
+
+		// Number of the first puzzle of the block within the stream
+		uint64_t first;
+	} block_t;
+
+	// Block being read and block being solved, if any, the two of them take turns
+	block_t m_blocks[2];
+	uint32_t m_reading;
+	block_t *m_solving;
+
+	// Whether the solutions are written to an archive instead of text
+	bool m_binary;
+	CSudokuArchive m_archive;
+
+	// Solutions shared by the grids of the workers, if any
+	CSudokuCache *m_cache;
+
+	// Number of puzzles read, solved and solved by the propagation of the lanes alone
+	uint64_t m_nrofPuzzles;
+	uint64_t m_nrofSolved;
+	uint64_t m_nrofPropagated;
+
+	// Time spent on each puzzle, in nanoseconds
+	std::vector<uint32_t> m_latency;
+
+private:
+	void copyPuzzle(const char *cells, FILE *out);
+	void addPuzzle(const char *puzzle, FILE *out);
+	void solveBlock(FILE *out);
+	void writeBlock(block_t &block, FILE *out);
+	void flush(FILE *out);
+	void solvePuzzle(const uint32_t workerId, const uint32_t puzzleId);
+	void solveLanes(const uint32_t workerId, const uint32_t groupId);
+	void printSummary(const double seconds);
+};
@@ -0,0 +1,268 @@
+#include "SudokuBench.h"
+#include "SudokuSamples.h"
+#include "SudokuKernels.h"
+#include "SudokuBoard.h"
+#include "SudokuSamurai.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+CSudokuBench::CSudokuBench(const uint32_t warmup, const uint32_t repetitions)
+	: m_warmup(warmup), m_repetitions(std::max<uint32_t>(1, repetitions)), m_table(&std::cout)
+{
+}
+
+CSudokuBench::~CSudokuBench()
+{
+}
+
+/**
+ * Runs all the cases, printing a line per case on the standard output. The results are also written
+ * as JSON to 'jsonFile' ('-' for the standard output) unless it is empty. Returns 1 when a case fails
+ */
+int CSudokuBench::run(const std::string &jsonFile)
+{
+	// The table goes to stderr when the standard output is taken by the JSON results
+	m_table = ("-" == jsonFile) ? &std::cerr : &std::cout;
+
+	*m_table << std::left << std::setw(20) << "case" << std::setw(12) << "corpus" << std::right
+		<< std::setw(10) << "samples" << std::setw(14) << "median us" << std::setw(14) << "p99 us" << std::setw(14) << "mean us" << std::endl;
+
+	const std::vector<const char *> samples(SAMPLE_PUZZLES, SAMPLE_PUZZLES + NROF_SAMPLE_PUZZLES);
+	const std::vector<const char *> hard(HARD_PUZZLES, HARD_PUZZLES + NROF_HARD_PUZZLES);
+
+	const std::vector<const char *> boards16(BOARD16_PUZZLES, BOARD16_PUZZLES + NROF_BOARD16_PUZZLES);
+
+	bool success = measureCorpus("samples", samples) && measureCorpus("hard", hard)
+		&& measureBoards<3>("hard", hard) && measureBoards<4>("16x16", boards16) && measureSamurai();
+
+	for (uint8_t level = EASY; success && (level < NROF_LEVELS); level++) {
+
+		// The same sequence of puzzles on every run of the benchmark
+		uint64_t number = 0;
+
+		success = measure("generate", "level " + std::to_string(level), 1, nullptr, [level, &number](CSudokuGrid &grid, const uint32_t) {
+			grid.generate(level, 0, number++, false);
+			return grid.isSolved();
+		});
+	}
+
+	if (false == success) {
+		return 1;
+	}
+
+	if ("-" == jsonFile) {
+		writeJson(std::cout);
+	}
+	else if (false == jsonFile.empty()) {
+
+		std::ofstream out(jsonFile);
+
+		if (false == out.is_open()) {
+
+			std::cerr << "Unable to open file " << jsonFile << std::endl;
+			return 1;
+		}
+
+		writeJson(out);
+	}
+
+	return 0;
+}
+
+/**
+ * Measures readLine (which scans the units of the grid), checkGrid, search and solve (with both engines,
+ * and with the advanced techniques) on every puzzle of a corpus
+ */
+bool CSudokuBench::measureCorpus(const std::string &corpus, const std::vector<const char *> &puzzles)
+{
+	const uint32_t nrofPuzzles = (uint32_t)puzzles.size();
+
+	const step_t read = [&puzzles](CSudokuGrid &grid, const uint32_t puzzleId) {
+		grid.setLogic(LOGIC_NONE);
+		return grid.readLine(puzzles[puzzleId], NROF_ROWS * NROF_COLS);
+	};
+
+	// Same as 'read', with all the advanced techniques enabled
+	const step_t readLogic = [&read](CSudokuGrid &grid, const uint32_t puzzleId) {
+		const bool success = read(grid, puzzleId);
+		grid.setLogic(LOGIC_ALL);
+		return success;
+	};
+
+	// Basic techniques only, from the puzzle as read
+	const step_t check = [](CSudokuGrid &grid, const uint32_t) {
+		uint32_t iter = 0;
+		return (NOT_VALID != grid.checkGrid(iter, false));
+	};
+
+	// Brute force only, from the grid left by the basic techniques
+	const step_t readAndCheck = [&read, &check](CSudokuGrid &grid, const uint32_t puzzleId) {
+		return read(grid, puzzleId) && check(grid, puzzleId);
+	};
+
+	const step_t search = [](CSudokuGrid &grid, const uint32_t) {
+		searchStats_t stats = searchStats_t();
+		return grid.isSolved() || (VALID_SOLVED == grid.search(stats, false));
+	};
+
+	const step_t solveBacktrack = [](CSudokuGrid &grid, const uint32_t) {
+		searchStats_t stats = searchStats_t();
+		return (VALID_SOLVED == grid.solve(stats, false, ENGINE_BACKTRACK));
+	};
+
+	const step_t solveDLX = [](CSudokuGrid &grid, const uint32_t) {
+		searchStats_t stats = searchStats_t();
+		return (VALID_SOLVED == grid.solve(stats, false, ENGINE_DLX));
+	};
+
+	return measure("readLine", corpus, nrofPuzzles, nullptr, read)
+		&& measure("checkGrid", corpus, nrofPuzzles, read, check)
+		&& measure("search", corpus, nrofPuzzles, readAndCheck, search)
+		&& measure("solve/backtrack", corpus, nrofPuzzles, read, solveBacktrack)
+		&& measure("solve/dlx", corpus, nrofPuzzles, read, solveDLX)
+		&& measure("solve/logic", corpus, nrofPuzzles, readLogic, solveBacktrack);
+}
+
+/**
+ * Measures the solve of CSudokuBoard on every board of a corpus, which gives the cost of the generic
+ * solver against CSudokuGrid on the 9x9 corpora
+ */
+template <uint32_t BOX>
+bool CSudokuBench::measureBoards(const std::string &corpus, const std::vector<const char *> &boards)
+{
+	CSudokuBoard<BOX> board;
+
+	const step_t read = [&board, &boards](CSudokuGrid &, const uint32_t boardId) {
+		return board.readLine(boards[boardId], CSudokuBoard<BOX>::BOARD_CELLS);
+	};
+
+	const step_t solve = [&board](CSudokuGrid &, const uint32_t) {
+		searchStats_t stats = searchStats_t();
+		return (VALID_SOLVED == board.solve(stats));
+	};
+
+	return measure("solve/board", corpus, (uint32_t)boards.size(), read, solve);
+}
+
+/**
+ * Measures the solve of the built-in Samurai puzzle and the generation of Samurai puzzles
+ */
+bool CSudokuBench::measureSamurai()
+{
+	CSudokuSamurai samurai;
+
+	const step_t read = [&samurai](CSudokuGrid &, const uint32_t) {
+		return samurai.readLine(SAMURAI_PUZZLE, SAMURAI_SIZE * SAMURAI_SIZE);
+	};
+
+	const step_t solve = [&samurai](CSudokuGrid &, const uint32_t) {
+		searchStats_t stats = searchStats_t();
+		return (VALID_SOLVED == samurai.solve(stats));
+	};
+
+	// The same sequence of puzzles on every run of the benchmark
+	uint64_t number = 0;
+
+	const step_t generate = [&samurai, &number](CSudokuGrid &, const uint32_t) {
+		return (0 != samurai.generate(0, number++));
+	};
+
+	return measure("solve/samurai", "samurai", 1, read, solve)
+		&& measure("generate", "samurai", 1, nullptr, generate);
+}
+
+/**
+ * Runs 'step' on every item of a corpus, 'm_warmup' times first and then 'm_repetitions' times timing
+ * each of them. Returns false, after printing the item on stderr, as soon as a step fails
+ */
+bool CSudokuBench::measure(const std::string &name, const std::string &corpus, const uint32_t nrofItems, const step_t &prepare, const step_t &step)
+{
+	std::vector<uint64_t> times;
+	times.reserve(m_repetitions * nrofItems);
+
+	for (uint32_t run = 0; run < m_warmup + m_repetitions; run++) {
+
+		for (uint32_t itemId = 0; itemId < nrofItems; itemId++) {
+
+			bool success = (nullptr == prepare) || prepare(m_grid, itemId);
+
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			success = success && step(m_grid, itemId);
+
+			const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+			if (false == success) {
+
+				std::cerr << name << " failed on item " << itemId << " of corpus " << corpus << std::endl;
+				return false;
+			}
+
+			if (run >= m_warmup) {
+				times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+			}
+		}
+	}
+
+	std::sort(times.begin(), times.end());
+
+	uint64_t total = 0;
+	for (std::vector<uint64_t>::iterator it = times.begin(); it != times.end(); ++it) {
+		total += *it;
+	}
+
+	result_t result;
+
+	result.name = name;
+	result.corpus = corpus;
+	result.nrofSamples = (uint32_t)times.size();
+	result.median = times[times.size() / 2] / 1000.0;
+	result.p99 = times[(times.size() * 99) / 100] / 1000.0;
+	result.mean = ((double)total / times.size()) / 1000.0;
+
+	m_results.push_back(result);
+	printResult(result);
+
+	return true;
+}
+
+/**
+ * Prints a line of the table of results
+ */
+void CSudokuBench::printResult(const result_t &result) const
+{
+	*m_table << std::left << std::setw(20) << result.name << std::setw(12) << result.corpus << std::right
+		<< std::fixed << std::setprecision(2)
+		<< std::setw(10) << result.nrofSamples << std::setw(14) << result.median << std::setw(14) << result.p99 << std::setw(14) << result.mean << std::endl;
+}
+
+/**
+ * Writes the settings of the run and the results of all the cases as a JSON object
+ */
+void CSudokuBench::writeJson(std::ostream &out) const
+{
+	out << "{\n"
+		<< "  \"warmup\": " << m_warmup << ",\n"
+		<< "  \"repetitions\": " << m_repetitions << ",\n"
+		<< "  \"unit\": \"us\",\n"
+		<< "  \"kernel\": \"" << kernelName(bestKernel()) << "\",\n"
+		<< "  \"results\": [\n";
+
+	out << std::fixed << std::setprecision(3);
+
+	for (std::vector<result_t>::const_iterator it = m_results.begin(); it != m_results.end(); ++it) {
+
+		out << "    { \"name\": \"" << it->name << "\", \"corpus\": \"" << it->corpus << "\", \"samples\": " << it->nrofSamples
+			<< ", \"median\": " << it->median << ", \"p99\": " << it->p99 << ", \"mean\": " << it->mean << " }"
+			<< ((it + 1 != m_results.end()) ? ",\n" : "\n");
+	}
+
+	out << "  ]\n"
+		<< "}" << std::endl;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "SudokuGrid.h"
+
+
+// Runs of every case that are discarded before measuring
+#define BENCH_WARMUP (3)
+
+// Measured runs of every case
+#define BENCH_REPETITIONS (20)
+
+
+/**
+ * Benchmark of the solver and the generator on fixed corpora: the sample puzzles, a set of
+ * well known hard puzzles, a few 16x16 boards and a Samurai puzzle built into the program.
+ *
+ * Every case is run over its corpus a few times to warm up and then measured for a number of
+ * repetitions, timing each operation on its own. The median, p99 and mean time per operation are
+ * printed as a table and, optionally, written as JSON so that runs can be compared automatically.
+ */
+class CSudokuBench
+{
+public:
+	CSudokuBench(const uint32_t warmup = BENCH_WARMUP, const uint32_t repetitions = BENCH_REPETITIONS);
+	~CSudokuBench();
+
+	int run(const std::string &jsonFile);
+
+private:
+	// Operation of a case on item 'itemId' of its corpus. The preparation step is not timed
+	typedef std::function<bool(CSudokuGrid &grid, const uint32_t itemId)> step_t;
+
+	// Times of a case, in microseconds per operation
+	typedef struct {
+		std::string name;
+		std::string corpus;
+		uint32_t nrofSamples;
+		double median;
+		double p99;
+		double mean;
+	} result_t;
+
+	uint32_t m_warmup;
+	uint32_t m_repetitions;
+
+	CSudokuGrid m_grid;
+
+	// Stream where the table of results is printed
+	std::ostream *m_table;
+
+	std::vector<result_t> m_results;
+
+private:
+	bool measure(const std::string &name, const std::string &corpus, const uint32_t nrofItems, const step_t &prepare, const step_t &step);
+	bool measureCorpus(const std::string &corpus, const std::vector<const char *> &puzzles);
+
+	template <uint32_t BOX>
+	bool measureBoards(const std::string &corpus, const std::vector<const char *> &boards);
+	bool measureSamurai();
+
+	void printResult(const result_t &result) const;
+	void writeJson(std::ostream &out) const;
+};
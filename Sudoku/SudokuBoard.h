@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "SudokuEngine.h"
+#include "SudokuGrid.h"
+#include "SudokuPool.h"
+
+
+// Boards read before they are solved together by the workers, and their solutions written in order
+#define BOARD_BLOCK_SIZE (4096)
+
+/**
+ * Geometry of a board of any box size for CSudokuEngine: rows, columns and then boxes, each unit crossing
+ * BOX units of the other kinds (a row or a column its boxes, a box its rows and its columns)
+ */
+template <uint32_t BOX>
+struct boardGeometry_t {
+
+	static constexpr uint32_t VALUES = BOX * BOX;
+	static constexpr uint32_t CELLS = VALUES * VALUES;
+	static constexpr uint32_t UNITS = 3 * VALUES;
+	static constexpr uint32_t CELL_UNITS = 3;
+	static constexpr uint32_t SEGMENTS = 2 * BOX;
+	static constexpr uint32_t SHARED = BOX;
+
+	static const engineTables_t<boardGeometry_t> &tables()
+	{
+		static const engineTables_t<boardGeometry_t> TABLES = buildTables();
+		return TABLES;
+	}
+
+	static engineTables_t<boardGeometry_t> buildTables()
+	{
+		engineTables_t<boardGeometry_t> tables;
+
+		tables.clear();
+
+		for (uint32_t rowId = 0; rowId < VALUES; rowId++) {
+
+			for (uint32_t colId = 0; colId < VALUES; colId++) {
+
+				const uint16_t cellId = (uint16_t)(rowId * VALUES + colId);
+				const uint32_t boxId = (rowId / BOX) * BOX + colId / BOX;
+
+				tables.addCell((uint16_t)rowId, colId, cellId);
+				tables.addCell((uint16_t)(VALUES + colId), rowId, cellId);
+				tables.addCell((uint16_t)(2 * VALUES + boxId), (rowId % BOX) * BOX + colId % BOX, cellId);
+			}
+		}
+
+		// Every box crosses BOX rows and BOX columns
+		for (uint32_t boxId = 0; boxId < VALUES; boxId++) {
+
+			const uint16_t boxUnit = (uint16_t)(2 * VALUES + boxId);
+
+			for (uint32_t lineId = 0; lineId < BOX; lineId++) {
+
+				const uint16_t rowUnit = (uint16_t)((boxId / BOX) * BOX + lineId);
+				const uint16_t colUnit = (uint16_t)(VALUES + (boxId % BOX) * BOX + lineId);
+
+				tables.addSegment(boxUnit, rowUnit);
+				tables.addSegment(rowUnit, boxUnit);
+				tables.addSegment(boxUnit, colUnit);
+				tables.addSegment(colUnit, boxUnit);
+			}
+		}
+
+		return tables;
+	}
+};
+
+
+/**
+ * Boards of any box size: 2 (4x4), 3 (9x9), 4 (16x16) or 5 (25x25). Values are written '1' to '9' and then
+ * 'A', 'B'... so a 16x16 board uses '1'-'9' and 'A'-'G', any other character is an empty cell.
+ *
+ * The board only reads and writes the cells, it is solved by CSudokuEngine with the tables of its geometry
+ * (see boardGeometry_t). The candidate masks take 16 bits up to 16 values and 32 bits above. CSudokuGrid
+ * remains the solver of 9x9 puzzles, with its box and band techniques.
+ */
+template <uint32_t BOX>
+class CSudokuBoard
+{
+	static_assert((BOX >= 2) && (BOX <= 5), "Box sizes from 2 (4x4) to 5 (25x25)");
+
+public:
+	// Values, as well as rows, columns and boxes
+	static constexpr uint32_t SIZE = BOX * BOX;
+
+	static constexpr uint32_t BOARD_CELLS = SIZE * SIZE;
+	static constexpr uint32_t BOARD_UNITS = 3 * SIZE;
+
+	typedef typename CSudokuEngine<boardGeometry_t<BOX>>::mask_t mask_t;
+
+public:
+	/**
+	 * Reads a board from a single line of BOARD_CELLS characters, row after row
+	 */
+	bool readLine(const char *line, const size_t length)
+	{
+		if (length < BOARD_CELLS) {
+			return false;
+		}
+
+		m_engine.clear();
+
+		for (uint32_t cellId = 0; cellId < BOARD_CELLS; cellId++) {
+
+			const int valId = fromChar(line[cellId]);
+
+			if (valId >= 0) {
+				m_engine.setCell(cellId, (mask_t)(1u << valId));
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * Writes the board as a single line of BOARD_CELLS characters (no end of line), '.' for the cells not assigned
+	 */
+	void writeLine(char *line) const
+	{
+		for (uint32_t cellId = 0; cellId < BOARD_CELLS; cellId++) {
+
+			const mask_t cell = m_engine.getCell(cellId);
+			line[cellId] = (1 == bitCount(cell)) ? toChar(bitIndex(cell)) : 46; // '.' = 46
+		}
+	}
+
+	/**
+	 * Solves the board, leaving it solved unless there is no solution
+	 */
+	int solve(searchStats_t &stats)
+	{
+		return m_engine.solve(stats);
+	}
+
+	/**
+	 * Number of solutions of the board, counting stops at 'limit'. The board is left as it was
+	 */
+	uint32_t countSolutions(const uint32_t limit = 2)
+	{
+		return m_engine.countSolutions(limit);
+	}
+
+	bool isSolved() const
+	{
+		return m_engine.isSolved();
+	}
+
+	bool hasConflict() const
+	{
+		return m_engine.hasConflict();
+	}
+
+	/**
+	 * Value written for 'valId' (0 = '1')
+	 */
+	static char toChar(const uint32_t valId)
+	{
+		return (char)((valId < 9) ? (49 + valId) : (65 + valId - 9)); // '1' = 49, 'A' = 65
+	}
+
+	/**
+	 * Value of a character, -1 for an empty cell
+	 */
+	static int fromChar(const char value)
+	{
+		int valId = -1;
+
+		// '1' = 49, '9' = 57, 'A' = 65, 'Z' = 90
+		if ((value >= 49) && (value <= 57)) {
+			valId = value - 49;
+		}
+		else if ((value >= 65) && (value <= 90)) {
+			valId = value - 65 + 9;
+		}
+
+		return (valId < (int)SIZE) ? valId : -1;
+	}
+
+	/**
+	 * Solves all the boards of a file ('-' or empty name for the standard input), one line per board, writing
+	 * one line with each solution to the standard output and the throughput on stderr
+	 */
+	static int run(const std::string &fileName, const uint32_t nrofThreads = 1)
+	{
+		if (fileName.empty() || ("-" == fileName)) {
+			return run(std::cin, std::cout, nrofThreads);
+		}
+
+		std::ifstream file(fileName);
+
+		if (false == file.is_open()) {
+
+			std::cerr << "Unable to open file " << fileName << std::endl;
+			return 1;
+		}
+
+		return run(file, std::cout, nrofThreads);
+	}
+
+	/**
+	 * Solves the boards of a stream in blocks of BOARD_BLOCK_SIZE, shared by a pool of workers each one
+	 * with its own board. The solutions are written in the same order as the boards were read
+	 */
+	static int run(std::istream &in, std::ostream &out, const uint32_t nrofThreads = 1)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		CSudokuPool pool(nrofThreads);
+		std::vector<CSudokuBoard> boards(pool.getNrofThreads());
+
+		std::vector<std::string> lines;
+		std::vector<char> results(BOARD_BLOCK_SIZE * (BOARD_CELLS + 1), '\n');
+		std::vector<uint8_t> solved(BOARD_BLOCK_SIZE);
+
+		const CSudokuPool::task_t solveLine = [&boards, &lines, &results, &solved](const uint32_t workerId, const uint32_t lineId) {
+
+			CSudokuBoard &board = boards[workerId];
+			char *result = &results[lineId * (BOARD_CELLS + 1)];
+			searchStats_t stats;
+
+			solved[lineId] = board.readLine(lines[lineId].data(), lines[lineId].size()) && (VALID_SOLVED == board.solve(stats));
+
+			if (solved[lineId]) {
+				board.writeLine(result);
+			}
+			else {
+				memset(result, 46, BOARD_CELLS); // '.' = 46
+			}
+		};
+
+		uint64_t nrofBoards = 0;
+		uint64_t nrofSolved = 0;
+		std::string line;
+		bool over = false;
+
+		while (false == over) {
+
+			lines.clear();
+
+			while (lines.size() < BOARD_BLOCK_SIZE) {
+
+				if (false == (bool)std::getline(in, line)) {
+
+					over = true;
+					break;
+				}
+
+				if (line.size() && ('\r' == line.back())) {
+					line.pop_back();
+				}
+
+				if (false == line.empty()) {
+					lines.push_back(line);
+				}
+			}
+
+			const uint32_t nrofLines = (uint32_t)lines.size();
+
+			pool.run(nrofLines, solveLine);
+
+			out.write(results.data(), (std::streamsize)nrofLines * (BOARD_CELLS + 1));
+
+			nrofBoards += nrofLines;
+			nrofSolved += std::count(solved.begin(), solved.begin() + nrofLines, 1);
+		}
+
+		out.flush();
+
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::cerr << std::fixed << std::setprecision(1)
+			<< "Solved " << nrofSolved << " of " << nrofBoards << " boards of " << SIZE << "x" << SIZE << " in " << seconds << " s: "
+			<< ((seconds > 0) ? nrofBoards / seconds : 0) << " boards/s" << std::endl;
+
+		return 0;
+	}
+
+private:
+	CSudokuEngine<boardGeometry_t<BOX>> m_engine;
+};
@@ -0,0 +1,97 @@
+#include "SudokuCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+CSudokuCache::CSudokuCache(const size_t capacity)
+	: m_capacity(capacity), m_nrofLookups(0), m_nrofHits(0)
+{
+	// Grows past that as needed
+	m_index.reserve(std::min<size_t>(capacity, CACHE_RESERVED));
+}
+
+CSudokuCache::~CSudokuCache()
+{
+}
+
+/**
+ * Looks for a puzzle in canonical form (81 characters), copying its solution in canonical form
+ */
+bool CSudokuCache::find(const char *canonical, char *solution)
+{
+	const std::string key(canonical, NROF_ROWS * NROF_COLS);
+
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	m_nrofLookups++;
+
+	std::unordered_map<std::string, std::list<entry_t>::iterator>::iterator it = m_index.find(key);
+
+	if (m_index.end() == it) {
+		return false;
+	}
+
+	// Most recently used
+	m_entries.splice(m_entries.begin(), m_entries, it->second);
+	memcpy(solution, it->second->second.data(), NROF_ROWS * NROF_COLS);
+
+	m_nrofHits++;
+
+	return true;
+}
+
+/**
+ * Adds the solution of a puzzle, both in canonical form, dropping the least recently used puzzle when full
+ */
+void CSudokuCache::insert(const char *canonical, const char *solution)
+{
+	if (0 == m_capacity) {
+		return;
+	}
+
+	const std::string key(canonical, NROF_ROWS * NROF_COLS);
+
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	// Solved meanwhile by another thread
+	if (m_index.end() != m_index.find(key)) {
+		return;
+	}
+
+	if (m_entries.size() == m_capacity) {
+
+		m_index.erase(m_entries.back().first);
+		m_entries.pop_back();
+	}
+
+	m_entries.push_front(entry_t(key, std::string(solution, NROF_ROWS * NROF_COLS)));
+	m_index[key] = m_entries.begin();
+}
+
+size_t CSudokuCache::getCapacity() const
+{
+	return m_capacity;
+}
+
+size_t CSudokuCache::size() const
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	return m_entries.size();
+}
+
+uint64_t CSudokuCache::getLookups() const
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	return m_nrofLookups;
+}
+
+uint64_t CSudokuCache::getHits() const
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	return m_nrofHits;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "SudokuGrid.h"
+
+
+// Puzzles the index is sized for at once
+#define CACHE_RESERVED (1 << 16)
+
+
+/**
+ * Solutions of the puzzles solved so far, keyed by the canonical form of the puzzle (see CSudokuCanonical)
+ * and kept in canonical form too, so that a puzzle equivalent to one already solved is solved by
+ * transforming back the solution (see CSudokuGrid::setCache).
+ *
+ * The cache keeps up to 'capacity' puzzles, the least recently used one is dropped to make room for a new
+ * one. It can be shared by the grids of several threads.
+ */
+class CSudokuCache
+{
+public:
+	CSudokuCache(const size_t capacity);
+	~CSudokuCache();
+
+	bool find(const char *canonical, char *solution);
+	void insert(const char *canonical, const char *solution);
+
+	size_t getCapacity() const;
+	size_t size() const;
+
+	uint64_t getLookups() const;
+	uint64_t getHits() const;
+
+private:
+	// Canonical puzzle and its solution, the most recently used first
+	typedef std::pair<std::string, std::string> entry_t;
+
+	std::list<entry_t> m_entries;
+	std::unordered_map<std::string, std::list<entry_t>::iterator> m_index;
+
+	size_t m_capacity;
+
+	uint64_t m_nrofLookups;
+	uint64_t m_nrofHits;
+
+	mutable std::mutex m_lock;
+};
@@ -0,0 +1,306 @@
+#include "SudokuCanonical.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// Orders of three items: the columns of a stack, or the stacks
+static const uint8_t PERMUTATIONS[6][3] = {
+	{ 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+};
+
+CSudokuCanonical::CSudokuCanonical()
+{
+}
+
+CSudokuCanonical::~CSudokuCanonical()
+{
+}
+
+/**
+ * Computes the canonical form of a puzzle in line format ('1'-'9' for a clue, any other character for an
+ * empty cell) and the transformation giving it. Fails when the puzzle has too many symmetries
+ */
+bool CSudokuCanonical::canonicalize(const char *line, char *canonical, transform_t &transform)
+{
+	for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+
+			const char value = line[rowId * NROF_COLS + colId];
+
+			// '0' = 48, '1' = 49, '9' = 57
+			m_values[0][rowId][colId] = ((value >= 49) && (value <= 57)) ? (uint8_t)(value - 48) : 0;
+			m_values[1][colId][rowId] = m_values[0][rowId][colId];
+		}
+	}
+
+	// The lowest first row only depends on the number of clues within each stack: the stacks with more
+	// clues go first, and the clues go first within each stack
+	uint32_t lowest = UINT32_MAX;
+	uint32_t pattern[2][NROF_ROWS];
+
+	for (uint8_t transposed = 0; transposed < 2; transposed++) {
+
+		for (uint8_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+			uint32_t counts[NROF_STACKS];
+
+			for (uint32_t stackId = 0; stackId < NROF_STACKS; stackId++) {
+
+				const uint8_t *cells = &m_values[transposed][rowId][stackId * 3];
+				counts[stackId] = (0 != cells[0]) + (0 != cells[1]) + (0 != cells[2]);
+			}
+
+			std::sort(counts, counts + NROF_STACKS, std::greater<uint32_t>());
+
+			// Bit set for an empty cell, read as a number from the first cell
+			uint32_t code = 0;
+
+			for (uint32_t stackId = 0; stackId < NROF_STACKS; stackId++) {
+				code = (code << 3) | ((1 << (3 - counts[stackId])) - 1);
+			}
+
+			pattern[transposed][rowId] = code;
+			lowest = std::min(lowest, code);
+		}
+	}
+
+	m_states.clear();
+
+	for (uint8_t transposed = 0; transposed < 2; transposed++) {
+
+		for (uint8_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+			if (lowest == pattern[transposed][rowId]) {
+				firstRow(transposed, rowId);
+			}
+		}
+	}
+
+	for (uint32_t position = 1; (position < NROF_ROWS) && (m_states.size() <= CANONICAL_MAX_STATES); position++) {
+
+		uint8_t best[NROF_COLS];
+		memset(best, UINT8_MAX, sizeof(best));
+
+		m_next.clear();
+
+		for (std::vector<state_t>::const_iterator it = m_states.begin(); it != m_states.end(); ++it) {
+
+			const uint16_t bandRows = 0x07 << (3 * (it->transform.rows[position - 1] / 3));
+
+			// A new band starts with any row of the bands left, otherwise the band goes on
+			for (uint8_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+				const uint16_t rowBit = 1 << rowId;
+				const uint16_t band = 0x07 << (3 * (rowId / 3));
+
+				if ((0 == (position % 3)) ? (0 == (it->usedRows & band)) : ((bandRows & rowBit) && (0 == (it->usedRows & rowBit)))) {
+					nextRow(*it, position, rowId, best);
+				}
+			}
+		}
+
+		m_states.swap(m_next);
+	}
+
+	if (m_states.empty() || (m_states.size() > CANONICAL_MAX_STATES)) {
+		return false;
+	}
+
+	// Values missing from the puzzle get the labels left, in order
+	transform = m_states.front().transform;
+	uint8_t nrofLabels = m_states.front().nrofLabels;
+
+	for (uint32_t value = 1; value <= NROF_VALUES; value++) {
+
+		if (0 == transform.labels[value]) {
+			transform.labels[value] = ++nrofLabels;
+		}
+	}
+
+	apply(transform, line, canonical);
+
+	return true;
+}
+
+/**
+ * Transforms a grid in line format, giving '.' for its empty cells
+ */
+void CSudokuCanonical::apply(const transform_t &transform, const char *line, char *canonical)
+{
+	for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+
+			const uint32_t fromRowId = transform.transposed ? transform.cols[colId] : transform.rows[rowId];
+			const uint32_t fromColId = transform.transposed ? transform.rows[rowId] : transform.cols[colId];
+			const char value = line[fromRowId * NROF_COLS + fromColId];
+
+			// '0' = 48, '1' = 49, '9' = 57, '.' = 46
+			canonical[rowId * NROF_COLS + colId] = ((value >= 49) && (value <= 57)) ? (char)(48 + transform.labels[value - 48]) : 46;
+		}
+	}
+}
+
+/**
+ * Transforms back a grid in canonical form, such as the solution of the canonical form of a puzzle
+ */
+void CSudokuCanonical::revert(const transform_t &transform, const char *canonical, char *line)
+{
+	uint8_t values[NROF_VALUES + 1] = { 0 };
+
+	for (uint32_t value = 1; value <= NROF_VALUES; value++) {
+		values[transform.labels[value]] = (uint8_t)value;
+	}
+
+	for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+
+			const uint32_t toRowId = transform.transposed ? transform.cols[colId] : transform.rows[rowId];
+			const uint32_t toColId = transform.transposed ? transform.rows[rowId] : transform.cols[colId];
+			const char label = canonical[rowId * NROF_COLS + colId];
+
+			// '0' = 48, '1' = 49, '9' = 57, '.' = 46
+			line[toRowId * NROF_COLS + toColId] = ((label >= 49) && (label <= 57)) ? (char)(48 + values[label - 48]) : 46;
+		}
+	}
+}
+
+/**
+ * Adds the partial transformations starting with a row, one for every order of the columns giving the
+ * lowest first row: stacks sorted by their number of clues, most first, and the clues first within each stack
+ */
+void CSudokuCanonical::firstRow(const uint8_t transposed, const uint8_t rowId)
+{
+	const uint8_t *cells = m_values[transposed][rowId];
+
+	// Orders of the columns of each stack that keep its clues first
+	uint8_t stackOrders[NROF_STACKS][6];
+	uint32_t nrofStackOrders[NROF_STACKS];
+	uint32_t counts[NROF_STACKS];
+
+	for (uint32_t stackId = 0; stackId < NROF_STACKS; stackId++) {
+
+		const uint8_t *stack = cells + stackId * 3;
+
+		counts[stackId] = (0 != stack[0]) + (0 != stack[1]) + (0 != stack[2]);
+		nrofStackOrders[stackId] = 0;
+
+		for (uint8_t orderId = 0; orderId < 6; orderId++) {
+
+			const uint8_t *order = PERMUTATIONS[orderId];
+
+			if (((0 != stack[order[0]]) >= (0 != stack[order[1]])) && ((0 != stack[order[1]]) >= (0 != stack[order[2]]))) {
+				stackOrders[stackId][nrofStackOrders[stackId]++] = orderId;
+			}
+		}
+	}
+
+	for (uint32_t stacksId = 0; stacksId < 6; stacksId++) {
+
+		const uint8_t *stacks = PERMUTATIONS[stacksId];
+
+		if ((counts[stacks[0]] < counts[stacks[1]]) || (counts[stacks[1]] < counts[stacks[2]])) {
+			continue;
+		}
+
+		for (uint32_t id0 = 0; id0 < nrofStackOrders[stacks[0]]; id0++) {
+
+			for (uint32_t id1 = 0; id1 < nrofStackOrders[stacks[1]]; id1++) {
+
+				for (uint32_t id2 = 0; id2 < nrofStackOrders[stacks[2]]; id2++) {
+
+					const uint32_t orderIds[NROF_STACKS] = { id0, id1, id2 };
+
+					state_t state;
+					memset(&state, 0, sizeof(state));
+
+					state.transform.transposed = transposed;
+					state.transform.rows[0] = rowId;
+					state.usedRows = (uint16_t)(1 << rowId);
+
+					for (uint32_t position = 0; position < NROF_STACKS; position++) {
+
+						const uint8_t stackId = stacks[position];
+						const uint8_t *order = PERMUTATIONS[stackOrders[stackId][orderIds[position]]];
+
+						for (uint32_t id = 0; id < 3; id++) {
+
+							const uint8_t colId = (uint8_t)(stackId * 3 + order[id]);
+							const uint8_t value = cells[colId];
+
+							state.transform.cols[position * 3 + id] = colId;
+
+							if (value) {
+								state.transform.labels[value] = ++state.nrofLabels;
+							}
+						}
+					}
+
+					m_states.push_back(state);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Extends a partial transformation with a row, kept if the row is not above the lowest one found so far
+ * at this position ('best'). A lower row replaces all the transformations kept before
+ */
+bool CSudokuCanonical::nextRow(const state_t &state, const uint32_t position, const uint8_t rowId, uint8_t *best)
+{
+	const uint8_t *cells = m_values[state.transform.transposed][rowId];
+
+	uint8_t labels[NROF_VALUES + 1];
+	uint8_t row[NROF_COLS];
+	uint8_t nrofLabels = state.nrofLabels;
+	bool lower = false;
+
+	memcpy(labels, state.transform.labels, sizeof(labels));
+
+	for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+
+		const uint8_t value = cells[state.transform.cols[colId]];
+
+		if (value && (0 == labels[value])) {
+			labels[value] = ++nrofLabels;
+		}
+
+		row[colId] = value ? labels[value] : CANONICAL_EMPTY;
+
+		if ((false == lower) && (row[colId] != best[colId])) {
+
+			if (row[colId] > best[colId]) {
+				return false;
+			}
+
+			lower = true;
+		}
+	}
+
+	if (lower) {
+
+		memcpy(best, row, sizeof(row));
+		m_next.clear();
+	}
+
+	// Too many symmetries, given up
+	if (m_next.size() > CANONICAL_MAX_STATES) {
+		return false;
+	}
+
+	m_next.push_back(state);
+
+	state_t &next = m_next.back();
+
+	memcpy(next.transform.labels, labels, sizeof(labels));
+	next.transform.rows[position] = rowId;
+	next.nrofLabels = nrofLabels;
+	next.usedRows |= (uint16_t)(1 << rowId);
+
+	return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "SudokuGrid.h"
+
+
+// Partial transformations kept at once while looking for the canonical form. Puzzles with so many
+// symmetries, such as almost empty grids, are left without canonical form
+#define CANONICAL_MAX_STATES (1 << 14)
+
+// Empty cells go after the clues in the canonical form, whatever their labels
+#define CANONICAL_EMPTY (NROF_VALUES + 1)
+
+// Transformation of a grid into its canonical form: the canonical cell (rowId, colId) holds the label of
+// the value at (rows[rowId], cols[colId]) of the grid, transposed first if needed
+typedef struct {
+	uint8_t transposed;
+	uint8_t rows[NROF_ROWS];
+	uint8_t cols[NROF_COLS];
+	uint8_t labels[NROF_VALUES + 1]; // Label of each value, from 1 to 9 (0 stays for empty cells)
+} transform_t;
+
+
+/**
+ * Canonical form of a puzzle under the transformations that keep the rules of Sudoku: transposition,
+ * permutation of the bands and of the rows within each band, the same for stacks and columns, and
+ * relabelling of the values. Equivalent puzzles get the same canonical form, so the solution of one of
+ * them gives the solution of all the others (see CSudokuCache).
+ *
+ * The canonical form is the lowest grid in line format, empty cells last, among all the transformations.
+ * For a given layout of the cells, the lowest labels are given to the values in the order they are first
+ * met. The form is built row after row: only the partial transformations giving the lowest rows so far
+ * are kept, the first row fixes most of the columns and every row fixes some more of them.
+ */
+class CSudokuCanonical
+{
+public:
+	CSudokuCanonical();
+	~CSudokuCanonical();
+
+	bool canonicalize(const char *line, char *canonical, transform_t &transform);
+
+	static void apply(const transform_t &transform, const char *line, char *canonical);
+	static void revert(const transform_t &transform, const char *canonical, char *line);
+
+private:
+	// Partial transformation, its first 'nrofRows' rows being the lowest ones
+	typedef struct {
+		transform_t transform;
+		uint8_t nrofLabels;
+		uint16_t usedRows;
+	} state_t;
+
+	// Values of the grid (0 for an empty cell) as read and transposed
+	uint8_t m_values[2][NROF_ROWS][NROF_COLS];
+
+	// Partial transformations of the current row and of the next one
+	std::vector<state_t> m_states;
+	std::vector<state_t> m_next;
+
+private:
+	void firstRow(const uint8_t transposed, const uint8_t rowId);
+	bool nextRow(const state_t &state, const uint32_t position, const uint8_t rowId, uint8_t *best);
+};
@@ -0,0 +1,396 @@
+#include "SudokuConstraints.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+using namespace std;
+
+// Moves of a knight and of a king in chess
+static const int8_t KNIGHT_OFFSETS[][2] = {
+	{ -2, -1 }, { -2, 1 }, { -1, -2 }, { -1, 2 }, { 1, -2 }, { 1, 2 }, { 2, -1 }, { 2, 1 }
+};
+
+static const int8_t KING_OFFSETS[][2] = {
+	{ -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, -1 }, { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 }
+};
+
+/**
+ * Reads a cell written as 'rXcY' (row and column from 1 to 9)
+ */
+static bool parseCell(const std::string &name, uint8_t &cellId)
+{
+	// 'r' = 114, 'c' = 99, '1' = 49, '9' = 57
+	if ((4 != name.size()) || (114 != name[0]) || (99 != name[2])
+		|| (name[1] < 49) || (name[1] > 57) || (name[3] < 49) || (name[3] > 57)) {
+		return false;
+	}
+
+	cellId = (uint8_t)((name[1] - 49) * NROF_COLS + (name[3] - 49));
+
+	return true;
+}
+
+CSudokuConstraints::CSudokuConstraints()
+{
+	clear();
+}
+
+CSudokuConstraints::~CSudokuConstraints()
+{
+}
+
+/**
+ * Adds a unit of up to 9 different cells that must hold different values
+ */
+bool CSudokuConstraints::addUnit(const std::vector<uint8_t> &cells)
+{
+	std::vector<uint8_t> sorted(cells);
+	std::sort(sorted.begin(), sorted.end());
+
+	if (sorted.empty() || (sorted.size() > NROF_VALUES) || (sorted.back() >= (NROF_ROWS * NROF_COLS))
+		|| (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())) {
+		return false;
+	}
+
+	constraint_t unit;
+
+	unit.type = CONSTRAINT_UNIT;
+	unit.sum = 0;
+	unit.cells = cells;
+
+	add(unit, (uint32_t)cells.size());
+
+	return true;
+}
+
+/**
+ * Adds a cage: up to 9 different cells that must hold different values adding up to 'sum'. Fails when
+ * no set of values fits the cage
+ */
+bool CSudokuConstraints::addCage(const std::vector<uint8_t> &cells, const uint32_t sum)
+{
+	std::vector<uint8_t> sorted(cells);
+	std::sort(sorted.begin(), sorted.end());
+
+	if (sorted.empty() || (sorted.size() > NROF_VALUES) || (sorted.back() >= (NROF_ROWS * NROF_COLS))
+		|| (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())) {
+		return false;
+	}
+
+	constraint_t cage;
+
+	cage.type = CONSTRAINT_CAGE;
+	cage.sum = (uint8_t)std::min<uint32_t>(sum, UINT8_MAX);
+	cage.cells = cells;
+
+	for (uint16_t combo = 1; combo <= ALL_CANDIDATES; combo++) {
+
+		if (cells.size() != bitCount(combo)) {
+			continue;
+		}
+
+		uint32_t comboSum = 0;
+
+		for (uint16_t mask = combo; mask; mask &= (mask - 1)) {
+			comboSum += bitIndex(mask) + 1;
+		}
+
+		if (comboSum == sum) {
+			cage.combos.push_back(combo);
+		}
+	}
+
+	if (cage.combos.empty()) {
+		return false;
+	}
+
+	add(cage, (uint32_t)cells.size());
+
+	return true;
+}
+
+/**
+ * Adds an exclusion for every cell: the cells at any of the (row, column) offsets from it cannot hold its
+ * value. The offsets are expected to come in opposite pairs, so every pair of cells excludes each other
+ */
+void CSudokuConstraints::addExclusions(const int8_t offsets[][2], const uint32_t nrofOffsets)
+{
+	for (int32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (int32_t colId = 0; colId < NROF_COLS; colId++) {
+
+			constraint_t exclusion;
+
+			exclusion.type = CONSTRAINT_EXCLUSION;
+			exclusion.sum = 0;
+			exclusion.cells.push_back((uint8_t)(rowId * NROF_COLS + colId));
+
+			for (uint32_t offsetId = 0; offsetId < nrofOffsets; offsetId++) {
+
+				const int32_t otherRowId = rowId + offsets[offsetId][0];
+				const int32_t otherColId = colId + offsets[offsetId][1];
+
+				if ((otherRowId >= 0) && (otherRowId < NROF_ROWS) && (otherColId >= 0) && (otherColId < NROF_COLS)) {
+					exclusion.cells.push_back((uint8_t)(otherRowId * NROF_COLS + otherColId));
+				}
+			}
+
+			// Only the cell itself decides what is excluded
+			add(exclusion, 1);
+		}
+	}
+}
+
+/**
+ * Both diagonals of the grid hold every value once (X-Sudoku)
+ */
+void CSudokuConstraints::addDiagonals()
+{
+	std::vector<uint8_t> main, anti;
+
+	for (uint8_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		main.push_back((uint8_t)(rowId * NROF_COLS + rowId));
+		anti.push_back((uint8_t)(rowId * NROF_COLS + (NROF_COLS - 1 - rowId)));
+	}
+
+	addUnit(main);
+	addUnit(anti);
+}
+
+/**
+ * Cells a knight move apart hold different values
+ */
+void CSudokuConstraints::addAntiKnight()
+{
+	addExclusions(KNIGHT_OFFSETS, sizeof(KNIGHT_OFFSETS) / sizeof(KNIGHT_OFFSETS[0]));
+}
+
+/**
+ * Cells that touch, even diagonally, hold different values
+ */
+void CSudokuConstraints::addAntiKing()
+{
+	addExclusions(KING_OFFSETS, sizeof(KING_OFFSETS) / sizeof(KING_OFFSETS[0]));
+}
+
+/**
+ * Reads the constraints of a variant from a text file, one per line ('#' starts a comment):
+ *
+ *   diagonals                  both diagonals hold every value
+ *   anti-knight, anti-king     cells a knight or king move apart hold different values
+ *   unit r1c1 r2c3 ...         cells that hold different values
+ *   cage 15 r1c1 r1c2 ...      cells that hold different values adding up to 15
+ */
+bool CSudokuConstraints::read(const std::string &fileName)
+{
+	std::ifstream file(fileName);
+
+	if (false == file.is_open()) {
+
+		std::cerr << "Unable to open file " << fileName << std::endl;
+		return false;
+	}
+
+	std::string line;
+	uint32_t lineId = 0;
+
+	while (getline(file, line)) {
+
+		lineId++;
+
+		const size_t comment = line.find('#');
+
+		if (std::string::npos != comment) {
+			line.erase(comment);
+		}
+
+		std::istringstream iss(line);
+		std::string kind;
+
+		if (false == static_cast<bool>(iss >> kind)) {
+			continue;
+		}
+
+		bool success = true;
+
+		if (kind == "diagonals") {
+			addDiagonals();
+		}
+		else if (kind == "anti-knight") {
+			addAntiKnight();
+		}
+		else if (kind == "anti-king") {
+			addAntiKing();
+		}
+		else if ((kind == "unit") || (kind == "cage")) {
+
+			uint32_t sum = 0;
+
+			if (kind == "cage") {
+				success = static_cast<bool>(iss >> sum);
+			}
+
+			std::vector<uint8_t> cells;
+			std::string name;
+
+			while (success && (iss >> name)) {
+
+				uint8_t cellId;
+
+				success = parseCell(name, cellId);
+				cells.push_back(cellId);
+			}
+
+			success = success && ((kind == "unit") ? addUnit(cells) : addCage(cells, sum));
+		}
+		else {
+			success = false;
+		}
+
+		if (false == success) {
+
+			std::cerr << "Wrong constraint in line " << lineId << ": " << line << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Removes all the constraints, leaving a standard Sudoku
+ */
+void CSudokuConstraints::clear()
+{
+	m_constraints.clear();
+
+	for (uint32_t groupId = 0; groupId < NROF_CONSTRAINT_GROUPS; groupId++) {
+		m_groups[groupId].clear();
+	}
+
+	for (uint32_t cellId = 0; cellId < (NROF_ROWS * NROF_COLS); cellId++) {
+		m_cellGroups[cellId] = 0;
+	}
+
+	m_allGroups = 0;
+}
+
+bool CSudokuConstraints::empty() const
+{
+	return m_constraints.empty();
+}
+
+uint32_t CSudokuConstraints::size() const
+{
+	return (uint32_t)m_constraints.size();
+}
+
+const constraint_t &CSudokuConstraints::get(const uint32_t constraintId) const
+{
+	assert(constraintId < m_constraints.size());
+
+	return m_constraints[constraintId];
+}
+
+/**
+ * Bits of the work queue to set when a cell changes
+ */
+uint64_t CSudokuConstraints::getGroups(const uint16_t rowId, const uint16_t colId) const
+{
+	assert(rowId < NROF_ROWS);
+	assert(colId < NROF_COLS);
+
+	return m_cellGroups[rowId * NROF_COLS + colId];
+}
+
+uint64_t CSudokuConstraints::getAllGroups() const
+{
+	return m_allGroups;
+}
+
+/**
+ * Constraints queued through bit 'NROF_UNITS + groupId' of the work queue
+ */
+const std::vector<uint32_t> &CSudokuConstraints::getGroup(const uint32_t groupId) const
+{
+	assert(groupId < NROF_CONSTRAINT_GROUPS);
+
+	return m_groups[groupId];
+}
+
+/**
+ * Verifies that the values assigned in a grid fulfill all the constraints. A cage that is not complete
+ * only needs its values to be part of a set of the right sum
+ */
+bool CSudokuConstraints::isValid(const uint16_t cells[NROF_ROWS][NROF_COLS]) const
+{
+	for (std::vector<constraint_t>::const_iterator it = m_constraints.begin(); it != m_constraints.end(); ++it) {
+
+		uint16_t assigned = 0;
+
+		for (uint8_t cellId : it->cells) {
+
+			const uint16_t cell = cells[cellId / NROF_COLS][cellId % NROF_COLS];
+
+			if (1 != bitCount(cell)) {
+				continue;
+			}
+
+			// An exclusion only compares its cell (the first one) with the others
+			if (CONSTRAINT_EXCLUSION == it->type) {
+
+				if (cellId == it->cells.front()) {
+					assigned = cell;
+				}
+				else if (assigned & cell) {
+					return false;
+				}
+
+				continue;
+			}
+
+			if (assigned & cell) {
+				return false;
+			}
+
+			assigned |= cell;
+		}
+
+		if ((CONSTRAINT_CAGE == it->type) && assigned) {
+
+			bool fits = false;
+
+			for (uint16_t combo : it->combos) {
+				fits = fits || (assigned == (combo & assigned));
+			}
+
+			if (false == fits) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Adds a constraint depending on its first 'nrofWatched' cells
+ */
+void CSudokuConstraints::add(const constraint_t &constraint, const uint32_t nrofWatched)
+{
+	const uint32_t constraintId = (uint32_t)m_constraints.size();
+	const uint32_t groupId = constraintId % NROF_CONSTRAINT_GROUPS;
+	const uint64_t groupBit = (uint64_t)1 << (NROF_UNITS + groupId);
+
+	m_constraints.push_back(constraint);
+	m_groups[groupId].push_back(constraintId);
+
+	for (uint32_t id = 0; id < nrofWatched; id++) {
+		m_cellGroups[constraint.cells[id]] |= groupBit;
+	}
+
+	m_allGroups |= groupBit;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SudokuGrid.h"
+
+
+// Kinds of constraints a variant adds to the rows, columns and boxes of the grid
+enum { CONSTRAINT_UNIT = 0, CONSTRAINT_CAGE, CONSTRAINT_EXCLUSION };
+
+// Cells are numbered row after row (rowId * NROF_COLS + colId)
+typedef struct {
+	uint8_t type;
+	uint8_t sum;                  // Cages only, the sum of their values
+	std::vector<uint8_t> cells;   // Exclusions: the cell and then the cells that cannot hold its value
+	std::vector<uint16_t> combos; // Cages only, every set of different values adding up to the sum
+} constraint_t;
+
+
+/**
+ * Constraints of a Sudoku variant, on top of the rows, columns and boxes of CSudokuGrid (see setConstraints):
+ *
+ * - Units: up to 9 cells that hold different values, such as the diagonals of X-Sudoku. A unit of 9 cells
+ *   holds every value, so it also gets hidden singles.
+ * - Cages: cells that hold different values adding up to a sum, as in Killer Sudoku. All the sets of values
+ *   with the size and sum of the cage are computed when it is added, the grid keeps the candidates that
+ *   belong to a set still possible.
+ * - Exclusions: a cell cannot hold the same value as the cells at some offsets from it, such as the knight
+ *   moves of anti-knight Sudoku. There is one exclusion per cell, only analysed once the cell is assigned.
+ *
+ * The constraints are analysed by the propagation loop of the grid, queued in the same work queue as the
+ * rows, columns and boxes. The queue has NROF_CONSTRAINT_GROUPS bits for them, constraint 'id' is queued
+ * through bit 'id % NROF_CONSTRAINT_GROUPS' whenever one of the cells it depends on changes.
+ */
+class CSudokuConstraints
+{
+public:
+	CSudokuConstraints();
+	~CSudokuConstraints();
+
+	bool addUnit(const std::vector<uint8_t> &cells);
+	bool addCage(const std::vector<uint8_t> &cells, const uint32_t sum);
+	void addExclusions(const int8_t offsets[][2], const uint32_t nrofOffsets);
+
+	void addDiagonals();
+	void addAntiKnight();
+	void addAntiKing();
+
+	bool read(const std::string &fileName);
+	void clear();
+
+	bool empty() const;
+	uint32_t size() const;
+	const constraint_t &get(const uint32_t constraintId) const;
+
+	uint64_t getGroups(const uint16_t rowId, const uint16_t colId) const;
+	uint64_t getAllGroups() const;
+	const std::vector<uint32_t> &getGroup(const uint32_t groupId) const;
+
+	bool isValid(const uint16_t cells[NROF_ROWS][NROF_COLS]) const;
+
+private:
+	std::vector<constraint_t> m_constraints;
+
+	// Constraints queued through each bit of the work queue
+	std::vector<uint32_t> m_groups[NROF_CONSTRAINT_GROUPS];
+
+	// Bits of the work queue (see NROF_UNITS) of the constraints that depend on each cell, and of all of them
+	uint64_t m_cellGroups[NROF_ROWS * NROF_COLS];
+	uint64_t m_allGroups;
+
+private:
+	void add(const constraint_t &constraint, const uint32_t nrofWatched);
+};
@@ -0,0 +1,605 @@
+#include "SudokuCorpus.h"
+#include "SudokuArchive.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/**
+ * Reads what a stream has to give, up to 'size' bytes, without waiting for more once some bytes came (the
+ * stdio buffer is bypassed, so the stream must not have been read through it). Returns -1 on error, 0 at the end
+ */
+static int64_t readChunk(FILE *in, char *data, const size_t size)
+{
+	for (;;) {
+
+#if defined(_WIN32)
+		const int64_t nrofBytes = _read(_fileno(in), data, (unsigned int)std::min<size_t>(size, INT32_MAX));
+#else
+		const int64_t nrofBytes = ::read(fileno(in), data, size);
+#endif
+
+		if ((nrofBytes >= 0) || (EINTR != errno)) {
+			return nrofBytes;
+		}
+	}
+}
+
+CSudokuCorpus::CSudokuCorpus()
+	: m_data(nullptr), m_end(nullptr), m_pos(nullptr), m_begin(nullptr), m_mapped(0), m_archive(-1), m_nrofRecords(0), m_nrofDecoded(0),
+	m_corrupted(false), m_stream(nullptr), m_readSize(CORPUS_READ_SIZE), m_eof(false), m_lastLine(nullptr), m_nrofCells(0)
+{
+#if defined(_WIN32)
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+#endif
+}
+
+CSudokuCorpus::~CSudokuCorpus()
+{
+	close();
+}
+
+/**
+ * Maps a file in memory ('-' or empty name for the standard input, which is read instead)
+ */
+bool CSudokuCorpus::open(const std::string &fileName)
+{
+	close();
+
+	if (fileName.empty() || ("-" == fileName)) {
+		return read(stdin);
+	}
+
+#if defined(_WIN32)
+	m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+	if (INVALID_HANDLE_VALUE == m_file) {
+
+		std::cerr << "Unable to open file " << fileName << std::endl;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (GetFileSizeEx(m_file, &fileSize) && (fileSize.QuadPart > 0)) {
+
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+		if (nullptr != m_mapping) {
+			m_data = (const char *)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+		}
+
+		if (nullptr != m_data) {
+			m_mapped = (size_t)fileSize.QuadPart;
+		}
+	}
+#else
+	const int fd = ::open(fileName.c_str(), O_RDONLY);
+
+	if (fd < 0) {
+
+		std::cerr << "Unable to open file " << fileName << std::endl;
+		return false;
+	}
+
+	struct stat status;
+
+	if ((0 == fstat(fd, &status)) && S_ISREG(status.st_mode) && (status.st_size > 0)) {
+
+		void *data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (MAP_FAILED != data) {
+
+			// The records are scanned once from the start to the end
+			madvise(data, (size_t)status.st_size, MADV_SEQUENTIAL);
+
+			m_data = (const char *)data;
+			m_mapped = (size_t)status.st_size;
+		}
+	}
+
+	::close(fd);
+#endif
+
+	if (m_mapped) {
+
+		m_end = m_data + m_mapped;
+		return openArchive();
+	}
+
+	// Empty files, pipes or mappings not supported
+	close();
+
+	FILE *in = fopen(fileName.c_str(), "rb");
+
+	if (nullptr == in) {
+
+		std::cerr << "Unable to open file " << fileName << std::endl;
+		return false;
+	}
+
+	const bool success = read(in);
+	fclose(in);
+
+	return success;
+}
+
+/**
+ * Reads a whole stream in memory, for the inputs that cannot be mapped
+ */
+bool CSudokuCorpus::read(FILE *in)
+{
+	assert(in);
+
+	close();
+
+	return readRest(in) && openArchive();
+}
+
+/**
+ * Reads a stream chunk by chunk as the records are taken (see next), chunks of 'readSize' bytes. Archives
+ * are recognised on the first chunk and read in memory, their checksum covers all the records
+ */
+bool CSudokuCorpus::stream(FILE *in, const size_t readSize)
+{
+	assert(in);
+	assert(readSize > 0);
+
+	close();
+
+	// Enough for the header of an archive, unless the stream is shorter
+	m_buffer.resize(std::max<size_t>(readSize, ARCHIVE_HEADER_SIZE));
+
+	size_t used = 0;
+
+	while (used < ARCHIVE_HEADER_SIZE) {
+
+		const int64_t nrofBytes = readChunk(in, m_buffer.data() + used, m_buffer.size() - used);
+
+		if (nrofBytes < 0) {
+
+			std::cerr << "Unable to read the input" << std::endl;
+			return false;
+		}
+
+		if (0 == nrofBytes) {
+
+			m_eof = true;
+			break;
+		}
+
+		used += (size_t)nrofBytes;
+	}
+
+	m_buffer.resize(used);
+
+	if (CSudokuArchive::isArchive((const uint8_t *)m_buffer.data(), m_buffer.size())) {
+		return readRest(in) && openArchive();
+	}
+
+	m_stream = in;
+	m_readSize = readSize;
+
+	m_data = m_buffer.data();
+	m_end = m_data + used;
+
+	if (false == openArchive()) {
+		return false;
+	}
+
+	findLastLine();
+
+	return true;
+}
+
+/**
+ * Appends the rest of a stream to the contents read so far
+ */
+bool CSudokuCorpus::readRest(FILE *in)
+{
+	size_t used = m_buffer.size();
+	int64_t nrofBytes;
+
+	do {
+
+		m_buffer.resize(used + CORPUS_READ_SIZE);
+
+		nrofBytes = readChunk(in, m_buffer.data() + used, CORPUS_READ_SIZE);
+		used += (size_t)std::max<int64_t>(nrofBytes, 0);
+
+	} while (nrofBytes > 0);
+
+	m_buffer.resize(used);
+
+	m_data = m_buffer.data();
+	m_end = m_data + used;
+
+	if (nrofBytes < 0) {
+
+		std::cerr << "Unable to read the input" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Reads the next chunk of a stream after the line not complete yet, which goes to the start of the
+ * buffer. Returns false when there is no stream or it is over
+ */
+bool CSudokuCorpus::refill()
+{
+	if ((nullptr == m_stream) || m_eof) {
+		return false;
+	}
+
+	const size_t kept = m_end - m_pos;
+
+	memmove(m_buffer.data(), m_pos, kept);
+	m_buffer.resize(kept + m_readSize);
+
+	const int64_t nrofBytes = readChunk(m_stream, m_buffer.data() + kept, m_readSize);
+	m_buffer.resize(kept + (size_t)std::max<int64_t>(nrofBytes, 0));
+
+	m_data = m_buffer.data();
+	m_begin = m_data;
+	m_pos = m_data;
+	m_end = m_data + m_buffer.size();
+
+	if (nrofBytes <= 0) {
+
+		if (nrofBytes < 0) {
+
+			std::cerr << "Unable to read the input" << std::endl;
+			m_corrupted = true;
+		}
+
+		m_eof = true;
+	}
+
+	findLastLine();
+
+	return true;
+}
+
+/**
+ * Finds the end of the last complete line of the current chunk of a stream
+ */
+void CSudokuCorpus::findLastLine()
+{
+	m_lastLine = nullptr;
+
+	for (const char *pos = m_end; pos > m_pos; pos--) {
+
+		if ('\n' == pos[-1]) {
+
+			m_lastLine = pos - 1;
+			break;
+		}
+	}
+}
+
+/**
+ * Whether the next record of a stream can only come once more bytes are written to it, so the caller
+ * may finish its work on the records it has before next() waits for them. Never true for a file, nor
+ * on Windows where the stream is not polled
+ */
+bool CSudokuCorpus::isWaiting() const
+{
+	if ((nullptr == m_stream) || m_eof || ((nullptr != m_lastLine) && (m_pos <= m_lastLine))) {
+		return false;
+	}
+
+#if defined(_WIN32)
+	return false;
+#else
+	struct pollfd request = { fileno(m_stream), POLLIN, 0 };
+
+	return (0 == poll(&request, 1, 0));
+#endif
+}
+
+/**
+ * Checks whether the contents are an archive, verifying its header and its checksum, and goes to the first record
+ */
+bool CSudokuCorpus::openArchive()
+{
+	const uint8_t *data = (const uint8_t *)m_data;
+	const size_t size = m_end - m_data;
+
+	m_archive = -1;
+	m_begin = m_data;
+	m_pos = m_data;
+
+	if (false == CSudokuArchive::isArchive(data, size)) {
+		return true;
+	}
+
+	if ((size < ARCHIVE_HEADER_SIZE) || (ARCHIVE_VERSION != data[4]) || (data[5] > ARCHIVE_SOLUTIONS) || (size < (ARCHIVE_HEADER_SIZE + ARCHIVE_TRAILER_SIZE))) {
+
+		std::cerr << "Unsupported or truncated archive" << std::endl;
+		return false;
+	}
+
+	const uint8_t *trailer = data + size - ARCHIVE_TRAILER_SIZE;
+	uint64_t nrofRecords = 0;
+	uint32_t checksum = 0;
+
+	for (uint32_t byteId = 0; byteId < 8; byteId++) {
+		nrofRecords |= (uint64_t)trailer[byteId] << (8 * byteId);
+	}
+
+	for (uint32_t byteId = 0; byteId < 4; byteId++) {
+		checksum |= (uint32_t)trailer[8 + byteId] << (8 * byteId);
+	}
+
+	if (checksum != CSudokuArchive::checksum(data + ARCHIVE_HEADER_SIZE, size - ARCHIVE_HEADER_SIZE - ARCHIVE_TRAILER_SIZE)) {
+
+		std::cerr << "Wrong checksum, the archive is corrupted" << std::endl;
+		return false;
+	}
+
+	m_archive = data[5];
+	m_nrofRecords = nrofRecords;
+	m_begin = m_data + ARCHIVE_HEADER_SIZE;
+	m_end = m_data + size - ARCHIVE_TRAILER_SIZE;
+	m_pos = m_begin;
+
+	return true;
+}
+
+/**
+ * Releases the mapping or the contents read
+ */
+void CSudokuCorpus::close()
+{
+#if defined(_WIN32)
+	if (m_mapped) {
+		UnmapViewOfFile(m_data);
+	}
+
+	if (nullptr != m_mapping) {
+		CloseHandle(m_mapping);
+	}
+
+	if (INVALID_HANDLE_VALUE != m_file) {
+		CloseHandle(m_file);
+	}
+
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+#else
+	if (m_mapped) {
+		munmap((void *)m_data, m_mapped);
+	}
+#endif
+
+	std::vector<char>().swap(m_buffer);
+
+	m_data = nullptr;
+	m_end = nullptr;
+	m_pos = nullptr;
+	m_begin = nullptr;
+	m_mapped = 0;
+	m_archive = -1;
+	m_nrofRecords = 0;
+	m_nrofDecoded = 0;
+	m_corrupted = false;
+	m_stream = nullptr;
+	m_readSize = CORPUS_READ_SIZE;
+	m_eof = false;
+	m_lastLine = nullptr;
+	m_nrofCells = 0;
+}
+
+/**
+ * Finds the next record: 'cells' points to its 81 cells, within the file for a puzzle in line format, or is
+ * null for an invalid record. Returns false once the file is over
+ */
+bool CSudokuCorpus::next(const char *&cells)
+{
+	if (m_archive >= 0) {
+		return nextRecord(cells);
+	}
+
+	while (false == m_corrupted) {
+
+		const char *line = m_pos;
+		const char *eol = (line < m_end) ? (const char *)memchr(line, '\n', m_end - line) : nullptr;
+
+		// The line goes on in the next chunk of a stream
+		if ((nullptr == eol) && refill()) {
+			continue;
+		}
+
+		if (m_pos >= m_end) {
+			break;
+		}
+
+		if (nullptr == eol) {
+			eol = m_end;
+		}
+
+		size_t length = eol - line;
+
+		if (length && ('\r' == line[length - 1])) {
+			length--;
+		}
+
+		if (length >= (NROF_ROWS * NROF_COLS)) {
+
+			// A record in grid format is cut short, the line is read again as the next record
+			if (m_nrofCells) {
+
+				m_nrofCells = 0;
+				cells = nullptr;
+
+				return true;
+			}
+
+			m_pos = (eol < m_end) ? eol + 1 : m_end;
+			cells = line;
+
+			return true;
+		}
+
+		// Cells of the line, spaces and tabs apart
+		char row[NROF_ROWS * NROF_COLS];
+		uint32_t nrofCells = 0;
+
+		for (size_t id = 0; id < length; id++) {
+
+			const char value = line[id];
+
+			// ' ' = 32, '\t' = 9
+			if ((32 != value) && (9 != value)) {
+				row[nrofCells++] = value;
+			}
+		}
+
+		if ((NROF_COLS != nrofCells) && m_nrofCells) {
+
+			// A record in grid format is cut short, the line is read again as the next record
+			m_nrofCells = 0;
+			cells = nullptr;
+
+			return true;
+		}
+
+		m_pos = (eol < m_end) ? eol + 1 : m_end;
+
+		if (0 == nrofCells) {
+			continue;
+		}
+
+		// Neither a row of a grid nor a whole puzzle
+		if (NROF_COLS != nrofCells) {
+
+			cells = nullptr;
+			return true;
+		}
+
+		memcpy(m_record + m_nrofCells, row, NROF_COLS);
+		m_nrofCells += NROF_COLS;
+
+		if ((NROF_ROWS * NROF_COLS) == m_nrofCells) {
+
+			m_nrofCells = 0;
+			cells = m_record;
+
+			return true;
+		}
+	}
+
+	// Last record in grid format cut short by the end of the file
+	if (m_nrofCells) {
+
+		m_nrofCells = 0;
+		cells = nullptr;
+
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Decodes the next record of an archive
+ */
+bool CSudokuCorpus::nextRecord(const char *&cells)
+{
+	if ((m_pos >= m_end) || m_corrupted) {
+		return false;
+	}
+
+	const uint8_t *record = (const uint8_t *)m_pos;
+	const size_t size = m_end - m_pos;
+	size_t recordSize = 0;
+
+	if (ARCHIVE_PUZZLES == m_archive) {
+		recordSize = CSudokuArchive::decodePuzzle(record, size, m_record);
+	}
+	else if ((size >= ARCHIVE_SOLUTION_SIZE) && CSudokuArchive::decodeSolution(record, m_record)) {
+		recordSize = ARCHIVE_SOLUTION_SIZE;
+	}
+
+	if (0 == recordSize) {
+
+		std::cerr << "Corrupted record " << m_nrofDecoded << " of the archive" << std::endl;
+
+		m_corrupted = true;
+		return false;
+	}
+
+	m_pos += recordSize;
+	m_nrofDecoded++;
+
+	cells = m_record;
+
+	return true;
+}
+
+/**
+ * Whether the cells of a record are within the file, so they stay in place until the corpus is closed.
+ * Records in grid format are overwritten by the next one
+ */
+bool CSudokuCorpus::inPlace(const char *cells) const
+{
+	return (nullptr != cells) && (m_record != cells) && (nullptr == m_stream);
+}
+
+/**
+ * Goes back to the first record, not for a stream
+ */
+void CSudokuCorpus::rewind()
+{
+	assert(nullptr == m_stream);
+
+	m_pos = m_begin;
+	m_nrofDecoded = 0;
+	m_corrupted = false;
+	m_nrofCells = 0;
+}
+
+bool CSudokuCorpus::isArchive() const
+{
+	return (m_archive >= 0);
+}
+
+/**
+ * Whether all the records of an archive were decoded, as many as its trailer tells. Always true for text,
+ * unless a stream could not be read to its end
+ */
+bool CSudokuCorpus::isComplete() const
+{
+	if (m_archive < 0) {
+		return (false == m_corrupted);
+	}
+
+	return (false == m_corrupted) && (m_pos == m_end) && (m_nrofDecoded == m_nrofRecords);
+}
+
+/**
+ * Size of the records in bytes
+ */
+uint64_t CSudokuCorpus::size() const
+{
+	return (uint64_t)(m_end - m_begin);
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "SudokuGrid.h"
+
+
+// Size of the blocks read from a file that cannot be mapped, or from a stream
+#define CORPUS_READ_SIZE (1 << 20)
+
+/**
+ * Read only view of a file of puzzles, split into records of 81 cells without copying them.
+ *
+ * The file is mapped in memory (mmap, or MapViewOfFile on Windows) and the records are found by scanning
+ * for the ends of line (memchr), so a puzzle in line format is handed over as a pointer into the mapping
+ * and goes straight to CSudokuGrid::readLine. Two layouts are recognised, even mixed in the same file:
+ *
+ * - Line format: a line of at least 81 characters is a puzzle, anything after the 81st one is ignored.
+ * - Grid format: 9 lines of exactly 9 cells each, as the files read by CSudokuGrid::readGrid. Spaces and
+ *   tabs are skipped, the cells are gathered into a small buffer of the corpus.
+ *
+ * Blank lines separate records. Any other line shorter than 81 cells makes an invalid record of its own,
+ * and so does a grid cut short before its 9th line (by a blank line, the end of the file or any line that
+ * is not a row). Invalid records are handed over as a null pointer so that the output of a batch keeps a
+ * line for them. Files that cannot be mapped, such as pipes, are read in memory instead and parsed the same way.
+ *
+ * A stream (see stream()) is read and parsed chunk by chunk instead, so its memory does not grow with the
+ * input and its first records are handed over before it is over. A line or a grid split between two chunks
+ * is carried over to the next one, the records of a stream are never in place. Archives are recognised on
+ * the first chunk and read in memory.
+ *
+ * Binary archives (see CSudokuArchive) are recognised by their header, their checksum is verified when
+ * they are opened and each record is decoded into the buffer of the corpus.
+ */
+class CSudokuCorpus
+{
+public:
+	CSudokuCorpus();
+	~CSudokuCorpus();
+
+	bool open(const std::string &fileName);
+	bool read(FILE *in);
+	bool stream(FILE *in, const size_t readSize = CORPUS_READ_SIZE);
+	void close();
+
+	bool next(const char *&cells);
+	bool isWaiting() const;
+	bool inPlace(const char *cells) const;
+	void rewind();
+
+	bool isArchive() const;
+	bool isComplete() const;
+
+	uint64_t size() const;
+
+private:
+	// Contents of the file, mapped or read, and the position of the next record
+	const char *m_data;
+	const char *m_end;
+	const char *m_pos;
+
+	// First record, after the header of an archive
+	const char *m_begin;
+
+	// Length of the mapping, zero when the file was read in memory
+	size_t m_mapped;
+
+	// Kind of records of an archive (see CSudokuArchive), -1 for a text file
+	int m_archive;
+
+	// Records of an archive according to its trailer, records decoded and whether one was corrupted (or a
+	// stream could not be read)
+	uint64_t m_nrofRecords;
+	uint64_t m_nrofDecoded;
+	bool m_corrupted;
+
+#if defined(_WIN32)
+	void *m_file;
+	void *m_mapping;
+#endif
+
+	// Contents of a file that could not be mapped, or the current chunk of a stream
+	std::vector<char> m_buffer;
+
+	// Stream read chunk by chunk, null once it is read in memory, the size of the chunks, whether it is over
+	// and the end of the last complete line of the current chunk
+	FILE *m_stream;
+	size_t m_readSize;
+	bool m_eof;
+	const char *m_lastLine;
+
+	// Cells of the record in grid format being gathered
+	char m_record[NROF_ROWS * NROF_COLS];
+	uint32_t m_nrofCells;
+
+private:
+	bool openArchive();
+	bool readRest(FILE *in);
+	bool refill();
+	void findLastLine();
+	bool nextRecord(const char *&cells);
+};
@@ -0,0 +1,207 @@
+#include "SudokuDLX.h"
+
+#include <algorithm>
+
+using namespace std;
+
+// Index of the root header, linked to all the column headers
+#define DLX_ROOT (DLX_NROF_COLUMNS)
+
+CSudokuDLX::CSudokuDLX()
+	: m_nrofNodes(0)
+{
+}
+
+CSudokuDLX::~CSudokuDLX()
+{
+}
+
+/**
+ * Solves the grid as an exact cover problem. On success, all the cells of the grid are assigned
+ */
+int CSudokuDLX::solve(CSudokuGrid &grid, searchStats_t &stats)
+{
+	build(grid);
+
+	if (false == search(0, stats)) {
+		return NOT_VALID;
+	}
+
+	for (uint32_t depth = 0; depth < (NROF_ROWS * NROF_COLS); depth++) {
+
+		const uint16_t candidate = m_candidate[m_solution[depth]];
+
+		const uint16_t rowId = candidate / (NROF_COLS * NROF_VALUES);
+		const uint16_t colId = (candidate / NROF_VALUES) % NROF_COLS;
+		const char value = (char)(49 + candidate % NROF_VALUES); // '1' = 49
+
+		if (1 < bitCount(grid.getCandidates(rowId, colId))) {
+			grid.assign(rowId, colId, value);
+		}
+	}
+
+	return grid.isSolved() ? VALID_SOLVED : NOT_VALID;
+}
+
+/**
+ * Builds the exact cover matrix with the candidates of the grid
+ */
+void CSudokuDLX::build(const CSudokuGrid &grid)
+{
+	for (uint16_t colId = 0; colId <= DLX_ROOT; colId++) {
+
+		m_left[colId] = (0 == colId) ? DLX_ROOT : colId - 1;
+		m_right[colId] = (DLX_ROOT == colId) ? 0 : colId + 1;
+		m_up[colId] = colId;
+		m_down[colId] = colId;
+		m_column[colId] = colId;
+	}
+
+	std::fill(m_size, m_size + DLX_NROF_COLUMNS, 0);
+	m_nrofNodes = DLX_ROOT + 1;
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+
+			for (uint16_t mask = grid.getCandidates(rowId, colId); mask; mask &= (mask - 1)) {
+				addCandidate(rowId, colId, (uint16_t)bitIndex(mask));
+			}
+		}
+	}
+}
+
+/**
+ * Appends the row of the matrix for value 'valId' (0 = '1') in cell (rowId, colId)
+ */
+void CSudokuDLX::addCandidate(const uint16_t rowId, const uint16_t colId, const uint16_t valId)
+{
+	assert(rowId < NROF_ROWS);
+	assert(colId < NROF_COLS);
+	assert(valId < NROF_VALUES);
+	assert(m_nrofNodes + 4 <= DLX_NROF_NODES);
+
+	const uint16_t boxId = (rowId / (NROF_ROWS / NROF_BANDS)) * NROF_STACKS + colId / (NROF_COLS / NROF_STACKS);
+	const uint16_t candidate = (rowId * NROF_COLS + colId) * NROF_VALUES + valId;
+
+	const uint16_t columns[4] = {
+		(uint16_t)(rowId * NROF_COLS + colId),
+		(uint16_t)(1 * NROF_ROWS * NROF_COLS + rowId * NROF_VALUES + valId),
+		(uint16_t)(2 * NROF_ROWS * NROF_COLS + colId * NROF_VALUES + valId),
+		(uint16_t)(3 * NROF_ROWS * NROF_COLS + boxId * NROF_VALUES + valId)
+	};
+
+	const uint16_t first = m_nrofNodes;
+
+	for (uint16_t id = 0; id < 4; id++) {
+
+		const uint16_t node = first + id;
+		const uint16_t column = columns[id];
+
+		m_left[node] = (0 == id) ? first + 3 : node - 1;
+		m_right[node] = (3 == id) ? first : node + 1;
+
+		m_up[node] = m_up[column];
+		m_down[node] = column;
+		m_down[m_up[column]] = node;
+		m_up[column] = node;
+
+		m_column[node] = column;
+		m_candidate[node] = candidate;
+		m_size[column]++;
+	}
+
+	m_nrofNodes += 4;
+}
+
+/**
+ * Removes a column from the header list and all the rows that cover it from the other columns
+ */
+void CSudokuDLX::cover(const uint16_t colId)
+{
+	m_right[m_left[colId]] = m_right[colId];
+	m_left[m_right[colId]] = m_left[colId];
+
+	for (uint16_t row = m_down[colId]; row != colId; row = m_down[row]) {
+
+		for (uint16_t node = m_right[row]; node != row; node = m_right[node]) {
+
+			m_down[m_up[node]] = m_down[node];
+			m_up[m_down[node]] = m_up[node];
+			m_size[m_column[node]]--;
+		}
+	}
+}
+
+/**
+ * Reverts a previous cover of the column, in the exact opposite order
+ */
+void CSudokuDLX::uncover(const uint16_t colId)
+{
+	for (uint16_t row = m_up[colId]; row != colId; row = m_up[row]) {
+
+		for (uint16_t node = m_left[row]; node != row; node = m_left[node]) {
+
+			m_size[m_column[node]]++;
+			m_down[m_up[node]] = node;
+			m_up[m_down[node]] = node;
+		}
+	}
+
+	m_right[m_left[colId]] = colId;
+	m_left[m_right[colId]] = colId;
+}
+
+/**
+ * Algorithm X. Covers the column with less rows left and tries each of its rows in turn
+ */
+bool CSudokuDLX::search(const uint32_t depth, searchStats_t &stats)
+{
+	if (DLX_ROOT == m_right[DLX_ROOT]) {
+		return true;
+	}
+
+	uint16_t best = m_right[DLX_ROOT];
+
+	for (uint16_t colId = m_right[best]; (colId != DLX_ROOT) && (1 < m_size[best]); colId = m_right[colId]) {
+
+		if (m_size[colId] < m_size[best]) {
+			best = colId;
+		}
+	}
+
+	if (0 == m_size[best]) {
+		return false;
+	}
+
+	// Columns with a single row left are forced, not a branch
+	const bool branch = (1 < m_size[best]);
+
+	stats.maxDepth = std::max(stats.maxDepth, depth);
+
+	cover(best);
+
+	for (uint16_t row = m_down[best]; row != best; row = m_down[row]) {
+
+		stats.branches += branch;
+		m_solution[depth] = row;
+
+		for (uint16_t node = m_right[row]; node != row; node = m_right[node]) {
+			cover(m_column[node]);
+		}
+
+		if (search(depth + 1, stats)) {
+			return true;
+		}
+
+		for (uint16_t node = m_left[row]; node != row; node = m_left[node]) {
+			uncover(m_column[node]);
+		}
+
+		stats.backtracks += branch;
+	}
+
+	uncover(best);
+
+	return false;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "SudokuGrid.h"
+
+
+// Constraints of the exact cover problem, one column each:
+//  cell (row, col) holds a value, row holds value n, column holds value n, box holds value n
+#define DLX_NROF_COLUMNS (4 * NROF_ROWS * NROF_COLS)
+
+// Candidates of the exact cover problem, one row each: cell (row, col) holds value n
+#define DLX_NROF_ROWS (NROF_ROWS * NROF_COLS * NROF_VALUES)
+
+// Column headers (plus root) and four nodes for every candidate
+#define DLX_NROF_NODES (DLX_NROF_COLUMNS + 1 + 4 * DLX_NROF_ROWS)
+
+
+/**
+ * Exact cover solver based on Knuth's Dancing Links (Algorithm X).
+ *
+ * The candidates of the grid are turned into the rows of the exact cover matrix, so the work done by
+ * the analysis techniques is kept. All nodes are preallocated within the object.
+ */
+class CSudokuDLX
+{
+public:
+	CSudokuDLX();
+	~CSudokuDLX();
+
+	int solve(CSudokuGrid &grid, searchStats_t &stats);
+
+private:
+	// Circular doubly linked lists in both directions, stored as node indexes
+	uint16_t m_left[DLX_NROF_NODES];
+	uint16_t m_right[DLX_NROF_NODES];
+	uint16_t m_up[DLX_NROF_NODES];
+	uint16_t m_down[DLX_NROF_NODES];
+
+	// Column header of each node and candidate (row of the matrix) it belongs to
+	uint16_t m_column[DLX_NROF_NODES];
+	uint16_t m_candidate[DLX_NROF_NODES];
+
+	// Number of nodes still linked within each column
+	uint16_t m_size[DLX_NROF_COLUMNS];
+
+	// Node of the candidate chosen at each depth of the search
+	uint16_t m_solution[NROF_ROWS * NROF_COLS];
+
+	uint16_t m_nrofNodes;
+
+private:
+	void build(const CSudokuGrid &grid);
+	void addCandidate(const uint16_t rowId, const uint16_t colId, const uint16_t valId);
+
+	void cover(const uint16_t colId);
+	void uncover(const uint16_t colId);
+
+	bool search(const uint32_t depth, searchStats_t &stats);
+};
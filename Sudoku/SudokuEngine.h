@@ -0,0 +1,564 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "SudokuGrid.h"
+
+
+// Smallest mask with a bit for each of the 'nrofValues' values of a puzzle
+template <uint32_t nrofValues>
+using engineMask_t = typename std::conditional<(nrofValues <= 16), uint16_t, uint32_t>::type;
+
+
+/**
+ * Geometry of the puzzles solved by CSudokuEngine, built once by the class of the puzzle: the cells of each
+ * unit, the units of each cell and the intersections of each unit with the units crossing it. GEOMETRY gives
+ * the sizes: VALUES (cells of a unit), CELLS, UNITS, CELL_UNITS (most units of a cell), SEGMENTS (most
+ * intersections of a unit) and SHARED (cells of an intersection)
+ */
+template <class GEOMETRY>
+struct engineTables_t {
+
+	// Intersection of a unit with a crossing one
+	typedef struct {
+		uint16_t cells[GEOMETRY::SHARED];                         // Cells shared by both units
+		uint16_t rest[GEOMETRY::VALUES - GEOMETRY::SHARED];       // Other cells of the unit
+		uint16_t crossRest[GEOMETRY::VALUES - GEOMETRY::SHARED];  // Other cells of the crossing unit
+	} segment_t;
+
+	// Cells of each unit, and units of each cell
+	uint16_t unitCells[GEOMETRY::UNITS][GEOMETRY::VALUES];
+	uint16_t cellUnits[GEOMETRY::CELLS][GEOMETRY::CELL_UNITS];
+	uint8_t nrofCellUnits[GEOMETRY::CELLS];
+
+	// Intersections of each unit with the units crossing it
+	segment_t segments[GEOMETRY::UNITS][GEOMETRY::SEGMENTS];
+	uint8_t nrofSegments[GEOMETRY::UNITS];
+
+	void clear()
+	{
+		memset(this, 0, sizeof(*this));
+	}
+
+	/**
+	 * Puts 'cellId' in 'slot' of 'unitId'
+	 */
+	void addCell(const uint16_t unitId, const uint32_t slot, const uint16_t cellId)
+	{
+		assert(nrofCellUnits[cellId] < GEOMETRY::CELL_UNITS);
+
+		unitCells[unitId][slot] = cellId;
+		cellUnits[cellId][nrofCellUnits[cellId]++] = unitId;
+	}
+
+	/**
+	 * Adds the intersection of 'unitId' with 'crossId', once the cells of both units are known
+	 */
+	void addSegment(const uint16_t unitId, const uint16_t crossId)
+	{
+		assert(nrofSegments[unitId] < GEOMETRY::SEGMENTS);
+
+		segment_t &segment = segments[unitId][nrofSegments[unitId]++];
+		const uint16_t *crossCells = unitCells[crossId];
+
+		uint32_t nrofShared = 0, nrofRest = 0, nrofCrossRest = 0;
+
+		for (uint16_t cellId : unitCells[unitId]) {
+
+			if (std::find(crossCells, crossCells + GEOMETRY::VALUES, cellId) != (crossCells + GEOMETRY::VALUES)) {
+				segment.cells[nrofShared++] = cellId;
+			}
+			else {
+				segment.rest[nrofRest++] = cellId;
+			}
+		}
+
+		for (uint16_t cellId : unitCells[crossId]) {
+
+			if (std::find(segment.cells, segment.cells + nrofShared, cellId) == (segment.cells + nrofShared)) {
+				segment.crossRest[nrofCrossRest++] = cellId;
+			}
+		}
+
+		assert(GEOMETRY::SHARED == nrofShared);
+	}
+};
+
+
+/**
+ * Solver shared by the puzzles that are not a single 9x9 grid (see CSudokuBoard and CSudokuSamurai), driven
+ * by the tables of their geometry (see engineTables_t) so that it knows nothing about their layout.
+ *
+ * It follows CSudokuGrid: a work queue of the units that lost candidates (a bit per unit), naked and hidden
+ * singles and the intersections of each unit with the units crossing it, and a depth first search on the
+ * cell with the fewest candidates that undoes its changes through a trail. A cell belongs to as many units
+ * as its geometry tells, so a cell shared by two grids passes its eliminations to both of them at once.
+ */
+template <class GEOMETRY>
+class CSudokuEngine
+{
+public:
+	typedef engineMask_t<GEOMETRY::VALUES> mask_t;
+
+	static constexpr mask_t ALL_VALUES = (mask_t)((1ull << GEOMETRY::VALUES) - 1);
+
+public:
+	CSudokuEngine()
+		: m_tables(GEOMETRY::tables()), m_trailActive(false), m_random(nullptr)
+	{
+		// Every cell and unit can only lose or gain each value once
+		m_trail.reserve((GEOMETRY::CELLS + GEOMETRY::UNITS) * GEOMETRY::VALUES + 1);
+
+		clear();
+	}
+
+	/**
+	 * Every cell gets all the candidates and every unit goes to the work queue
+	 */
+	void clear()
+	{
+		for (uint32_t cellId = 0; cellId < GEOMETRY::CELLS; cellId++) {
+			m_cells[cellId] = ALL_VALUES;
+		}
+
+		memset(m_placed, 0, sizeof(m_placed));
+		m_conflict = 0;
+
+		memset(m_dirty, 0, sizeof(m_dirty));
+
+		for (uint32_t unitId = 0; unitId < GEOMETRY::UNITS; unitId++) {
+			m_dirty[unitId / 32] |= (1u << (unitId % 32));
+		}
+	}
+
+	mask_t getCell(const uint32_t cellId) const
+	{
+		return m_cells[cellId];
+	}
+
+	/**
+	 * Stores the new candidates of a cell and queues all the units it belongs to. A single candidate is
+	 * assigned to those units, see CSudokuGrid::setCell
+	 */
+	void setCell(const uint32_t cellId, const mask_t mask)
+	{
+		if (m_cells[cellId] == mask) {
+			return;
+		}
+
+		store(m_cells[cellId], mask);
+
+		const uint16_t *units = m_tables.cellUnits[cellId];
+		const uint32_t nrofUnits = m_tables.nrofCellUnits[cellId];
+
+		for (uint32_t id = 0; id < nrofUnits; id++) {
+			m_dirty[units[id] / 32] |= (1u << (units[id] % 32));
+		}
+
+		if (0 == mask) {
+
+			store(m_conflict, 1);
+		}
+		else if (1 == bitCount(mask)) {
+
+			for (uint32_t id = 0; id < nrofUnits; id++) {
+
+				if (m_placed[units[id]] & mask) {
+					store(m_conflict, 1);
+				}
+
+				store(m_placed[units[id]], m_placed[units[id]] | mask);
+			}
+		}
+	}
+
+	/**
+	 * Solves the puzzle, leaving it solved unless there is no solution
+	 */
+	int solve(searchStats_t &stats)
+	{
+		stats = searchStats_t();
+
+		m_trail.clear();
+		m_trailActive = true;
+
+		const int retVal = searchTrail(stats, 0);
+
+		m_trailActive = false;
+
+		return retVal;
+	}
+
+	/**
+	 * Counts the solutions of the puzzle, stopping as soon as 'limit' of them are found, so a limit of 2
+	 * tells whether the solution is unique. The puzzle is left as it was
+	 */
+	uint32_t countSolutions(const uint32_t limit = 2)
+	{
+		uint32_t count = 0;
+
+		// The queue is not recorded in the trail
+		uint32_t dirty[(GEOMETRY::UNITS + 31) / 32];
+		memcpy(dirty, m_dirty, sizeof(m_dirty));
+
+		m_trail.clear();
+		m_trailActive = true;
+
+		countTrail(count, limit);
+		undo(0);
+
+		m_trailActive = false;
+
+		memcpy(m_dirty, dirty, sizeof(m_dirty));
+
+		return count;
+	}
+
+	/**
+	 * Fills the empty puzzle with a random solution, the candidates of every cell tried in random order
+	 */
+	bool fill(std::mt19937 &random)
+	{
+		clear();
+
+		m_trail.clear();
+		m_trailActive = true;
+		m_random = &random;
+
+		const int retVal = fillTrail();
+
+		m_trailActive = false;
+		m_random = nullptr;
+
+		return (VALID_SOLVED == retVal);
+	}
+
+	bool isSolved() const
+	{
+		for (uint32_t unitId = 0; unitId < GEOMETRY::UNITS; unitId++) {
+
+			if (ALL_VALUES != m_placed[unitId]) {
+				return false;
+			}
+		}
+
+		return (0 == m_conflict);
+	}
+
+	bool hasConflict() const
+	{
+		return (0 != m_conflict);
+	}
+
+private:
+	// Tables of the geometry, looked up once instead of on every access
+	const engineTables_t<GEOMETRY> &m_tables;
+
+	// Candidates of each cell, in the order of the geometry
+	mask_t m_cells[GEOMETRY::CELLS];
+
+	// Values assigned within each unit
+	mask_t m_placed[GEOMETRY::UNITS];
+
+	// Set when a cell runs out of candidates or a value cannot be placed within a unit
+	mask_t m_conflict;
+
+	// Work queue of the units that lost candidates (bit per unit)
+	uint32_t m_dirty[(GEOMETRY::UNITS + 31) / 32];
+
+	// Undo log of the search, only recorded while it is active
+	typedef struct { mask_t *word; mask_t value; } trailEntry_t;
+
+	std::vector<trailEntry_t> m_trail;
+	bool m_trailActive;
+
+	// Random generator of the puzzle being filled, not owned by the engine
+	std::mt19937 *m_random;
+
+private:
+	void store(mask_t &word, const mask_t value)
+	{
+		if (m_trailActive && (word != value)) {
+			m_trail.push_back({ &word, word });
+		}
+
+		word = value;
+	}
+
+	void undo(const size_t trailMark)
+	{
+		while (m_trail.size() > trailMark) {
+
+			*m_trail.back().word = m_trail.back().value;
+			m_trail.pop_back();
+		}
+	}
+
+	/**
+	 * Naked and hidden singles and intersections within a unit. A value that is neither assigned nor a
+	 * candidate is a conflict
+	 */
+	void checkUnit(const uint32_t unitId)
+	{
+		const uint16_t *cells = m_tables.unitCells[unitId];
+
+		for (uint32_t slot = 0; slot < GEOMETRY::VALUES; slot++) {
+
+			const mask_t cell = m_cells[cells[slot]];
+
+			if ((1 < bitCount(cell)) && (cell & m_placed[unitId])) {
+				setCell(cells[slot], cell & ~m_placed[unitId]);
+			}
+		}
+
+		mask_t cand = 0, candTwice = 0;
+
+		for (uint32_t slot = 0; slot < GEOMETRY::VALUES; slot++) {
+
+			const mask_t cell = m_cells[cells[slot]];
+
+			if (1 < bitCount(cell)) {
+
+				candTwice |= cand & cell;
+				cand |= cell;
+			}
+		}
+
+		if (ALL_VALUES & ~(cand | m_placed[unitId])) {
+
+			store(m_conflict, 1);
+			return;
+		}
+
+		const mask_t hidden = cand & ~candTwice & ~m_placed[unitId];
+
+		for (uint32_t slot = 0; hidden && (slot < GEOMETRY::VALUES); slot++) {
+
+			const mask_t cell = m_cells[cells[slot]];
+			const mask_t mask = cell & hidden;
+
+			if ((1 < bitCount(cell)) && mask) {
+				setCell(cells[slot], (1 == bitCount(mask)) ? mask : 0);
+			}
+		}
+
+		intersections(unitId);
+	}
+
+	/**
+	 * Intersections, see CSudokuGrid::checkBand: a value confined to the cells a unit shares with a crossing
+	 * unit is removed from the rest of the crossing unit
+	 */
+	void intersections(const uint32_t unitId)
+	{
+		const typename engineTables_t<GEOMETRY>::segment_t *segments = m_tables.segments[unitId];
+		const uint32_t nrofSegments = m_tables.nrofSegments[unitId];
+
+		for (uint32_t segmentId = 0; (segmentId < nrofSegments) && (0 == m_conflict); segmentId++) {
+
+			const typename engineTables_t<GEOMETRY>::segment_t &segment = segments[segmentId];
+
+			mask_t inside = 0;
+			mask_t outside = m_placed[unitId];
+
+			for (uint16_t cellId : segment.cells) {
+
+				const mask_t cell = m_cells[cellId];
+
+				if (1 < bitCount(cell)) {
+					inside |= cell;
+				}
+			}
+
+			for (uint16_t cellId : segment.rest) {
+				outside |= m_cells[cellId];
+			}
+
+			const mask_t confined = inside & ~outside;
+
+			if (0 == confined) {
+				continue;
+			}
+
+			for (uint16_t cellId : segment.crossRest) {
+
+				const mask_t cell = m_cells[cellId];
+
+				if ((1 < bitCount(cell)) && (cell & confined)) {
+					setCell(cellId, cell & ~confined);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Analyses the units of the work queue until it is empty or a conflict is found
+	 */
+	int checkPuzzle(uint32_t &iter)
+	{
+		for (uint32_t wordId = 0; (wordId < ((GEOMETRY::UNITS + 31) / 32)) && (0 == m_conflict); ) {
+
+			if (0 == m_dirty[wordId]) {
+
+				wordId++;
+				continue;
+			}
+
+			const uint32_t unitId = wordId * 32 + bitIndex(m_dirty[wordId]);
+			m_dirty[wordId] &= m_dirty[wordId] - 1;
+
+			checkUnit(unitId);
+			iter++;
+
+			// Units before this one may be back in the queue
+			wordId = 0;
+		}
+
+		if (m_conflict) {
+			return NOT_VALID;
+		}
+
+		return isSolved() ? VALID_SOLVED : VALID_NOT_SOLVED;
+	}
+
+	/**
+	 * Open cell with the fewest candidates
+	 */
+	uint32_t bestCell() const
+	{
+		uint32_t bestCellId = GEOMETRY::CELLS;
+		uint32_t bestSize = GEOMETRY::VALUES + 1;
+
+		for (uint32_t cellId = 0; cellId < GEOMETRY::CELLS; cellId++) {
+
+			const uint32_t size = bitCount(m_cells[cellId]);
+
+			if ((1 < size) && (size < bestSize)) {
+
+				bestCellId = cellId;
+				bestSize = size;
+
+				if (2 == size) {
+					break;
+				}
+			}
+		}
+
+		return bestCellId;
+	}
+
+	int searchTrail(searchStats_t &stats, const uint32_t depth)
+	{
+		const int retVal = checkPuzzle(stats.iter);
+
+		if (VALID_NOT_SOLVED != retVal) {
+			return retVal;
+		}
+
+		stats.maxDepth = std::max(stats.maxDepth, depth + 1);
+
+		const uint32_t cellId = bestCell();
+		const size_t trailMark = m_trail.size();
+
+		for (mask_t values = m_cells[cellId]; values; values &= (values - 1)) {
+
+			stats.branches++;
+
+			setCell(cellId, values & (mask_t)(0 - values));
+
+			if (VALID_SOLVED == searchTrail(stats, depth + 1)) {
+				return VALID_SOLVED;
+			}
+
+			stats.maxTrailDepth = std::max(stats.maxTrailDepth, (uint32_t)m_trail.size());
+			stats.backtracks++;
+
+			undo(trailMark);
+			clearDirty();
+		}
+
+		return NOT_VALID;
+	}
+
+	void countTrail(uint32_t &count, const uint32_t limit)
+	{
+		uint32_t iter = 0;
+		const int retVal = checkPuzzle(iter);
+
+		if (VALID_NOT_SOLVED != retVal) {
+
+			count += (VALID_SOLVED == retVal);
+			return;
+		}
+
+		const uint32_t cellId = bestCell();
+		const size_t trailMark = m_trail.size();
+
+		for (mask_t values = m_cells[cellId]; values && (count < limit); values &= (values - 1)) {
+
+			setCell(cellId, values & (mask_t)(0 - values));
+			countTrail(count, limit);
+
+			undo(trailMark);
+			clearDirty();
+		}
+	}
+
+	/**
+	 * Same as searchTrail, trying the candidates of the best cell in random order
+	 */
+	int fillTrail()
+	{
+		uint32_t iter = 0;
+		const int retVal = checkPuzzle(iter);
+
+		if (VALID_NOT_SOLVED != retVal) {
+			return retVal;
+		}
+
+		const uint32_t cellId = bestCell();
+		const size_t trailMark = m_trail.size();
+
+		mask_t values[GEOMETRY::VALUES];
+		uint32_t nrofValues = 0;
+
+		for (mask_t mask = m_cells[cellId]; mask; mask &= (mask - 1)) {
+			values[nrofValues++] = mask & (mask_t)(0 - mask);
+		}
+
+		// Fisher-Yates, see shuffle in SudokuGrid.cpp
+		for (uint32_t id = nrofValues; id > 1; id--) {
+
+			const uint32_t other = (uint32_t)(((uint64_t)(*m_random)() * id) >> 32);
+			std::swap(values[id - 1], values[other]);
+		}
+
+		for (uint32_t id = 0; id < nrofValues; id++) {
+
+			setCell(cellId, values[id]);
+
+			if (VALID_SOLVED == fillTrail()) {
+				return VALID_SOLVED;
+			}
+
+			undo(trailMark);
+			clearDirty();
+		}
+
+		return NOT_VALID;
+	}
+
+	// The queue is always empty once the changes of a branch are undone
+	void clearDirty()
+	{
+		memset(m_dirty, 0, sizeof(m_dirty));
+	}
+};
+
+template <class GEOMETRY>
+constexpr typename CSudokuEngine<GEOMETRY>::mask_t CSudokuEngine<GEOMETRY>::ALL_VALUES;
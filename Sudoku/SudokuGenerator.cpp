@@ -0,0 +1,247 @@
+#include "SudokuGenerator.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+CSudokuGenerator::CSudokuGenerator(const uint8_t level, const uint64_t seed, const uint32_t nrofThreads, const uint8_t mask, const uint32_t nrofClues, const uint32_t minScore)
+	: m_level(level), m_seed(seed), m_mask(mask), m_nrofClues(nrofClues ? nrofClues : GEN_CLUES[level]), m_minScore(minScore), m_first(0), m_pool(nrofThreads), m_grids(m_pool.getNrofThreads()), m_random(m_pool.getNrofThreads()), m_results(GENERATOR_WINDOW * (NROF_ROWS * NROF_COLS + 1)), m_ready(GENERATOR_WINDOW, 0), m_times(GENERATOR_WINDOW, 0), m_next(0), m_nrofRequested(0), m_out(nullptr),
+	m_binary(false), m_nrofPuzzles(0), m_nrofBelowScore(0)
+{
+	assert(level < NROF_LEVELS);
+}
+
+CSudokuGenerator::~CSudokuGenerator()
+{
+}
+
+/**
+ * Generates puzzles 'first' to 'first' + 'nrofPuzzles' - 1 of the sequence of the seed into a file ('-' or 
+ * empty name for the standard output)
+ */
+int CSudokuGenerator::run(const uint64_t first, const uint64_t nrofPuzzles, const std::string &fileName)
+{
+	if (fileName.empty() || ("-" == fileName)) {
+		return run(first, nrofPuzzles, stdout);
+	}
+
+	FILE *out = fopen(fileName.c_str(), "wb");
+
+	if (nullptr == out) {
+
+		std::cerr << "Unable to open file " << fileName << std::endl;
+		return 1;
+	}
+
+	const int retVal = run(first, nrofPuzzles, out);
+	fclose(out);
+
+	return retVal;
+}
+
+/**
+ * Generates the puzzles on all the workers at once, printing the progress every GENERATOR_PROGRESS puzzles
+ */
+int CSudokuGenerator::run(const uint64_t first, const uint64_t nrofPuzzles, FILE *out)
+{
+	assert(out);
+
+	m_first = first;
+	m_nrofPuzzles = 0;
+	m_nrofRequested = nrofPuzzles;
+	m_next = 0;
+	m_nrofBelowScore = 0;
+	m_out = out;
+	m_latency.clear();
+
+	m_start = std::chrono::steady_clock::now();
+
+	if (m_binary) {
+		m_archive.create(out, ARCHIVE_PUZZLES);
+	}
+
+	m_pool.run(m_pool.getNrofThreads(), [this](const uint32_t workerId, const uint32_t) { generateStream(workerId); });
+
+	if (false == m_binary) {
+		fflush(out);
+	}
+
+	const bool success = (false == m_binary) || m_archive.close();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+	printSummary(seconds);
+
+	if (m_nrofBelowScore) {
+		std::cerr << "Error: " << m_nrofBelowScore << " puzzles written with a score below " << m_minScore << " after " << GENERATOR_MAX_ATTEMPTS << " attempts each" << std::endl;
+	}
+
+	return (success && (0 == m_nrofBelowScore)) ? 0 : 1;
+}
+
+/**
+ * Writes the puzzles as a binary archive (see CSudokuArchive) instead of text
+ */
+void CSudokuGenerator::setBinary(const bool binary)
+{
+	m_binary = binary;
+}
+
+/**
+ * Main loop of a worker: takes the next puzzle of the run until there are none left, waiting when the
+ * reorder buffer has no room for it
+ */
+void CSudokuGenerator::generateStream(const uint32_t workerId)
+{
+	for (;;) {
+
+		const uint64_t index = m_next++;
+
+		if (index >= m_nrofRequested) {
+			return;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_lock);
+			m_written.wait(lock, [this, index]() { return (index < m_nrofPuzzles + GENERATOR_WINDOW); });
+		}
+
+		generatePuzzle(workerId, index);
+		writeReady(index);
+	}
+}
+
+/**
+ * Generates puzzle 'index' of the run into its slot of the reorder buffer with the grid of the worker. Its
+ * random generator is seeded with the seed of the run and the number of the puzzle within the sequence of the seed
+ */
+void CSudokuGenerator::generatePuzzle(const uint32_t workerId, const uint64_t index)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	const uint32_t slot = (uint32_t)(index % GENERATOR_WINDOW);
+
+	std::mt19937 &random = m_random[workerId];
+	CSudokuGrid::seedRandom(random, m_seed, m_first + index);
+
+	CSudokuGrid &grid = m_grids[workerId];
+	char *result = &m_results[slot * (NROF_ROWS * NROF_COLS + 1)];
+
+	for (uint32_t attempt = 0; attempt < GENERATOR_MAX_ATTEMPTS; attempt++) {
+
+		if (MASK_LEVEL == m_mask) {
+
+			grid.generate(m_level, random, false);
+			grid.writeLine(result, m_level);
+		}
+		else {
+
+			grid.generateClues(m_nrofClues, m_mask, random);
+			grid.writeLine(result);
+		}
+
+		if (0 == m_minScore) {
+			break;
+		}
+
+		rating_t rating;
+
+		grid.readLine(result, NROF_ROWS * NROF_COLS);
+		m_rater.rate(grid, rating);
+
+		if (rating.score >= m_minScore) {
+			break;
+		}
+
+		if (GENERATOR_MAX_ATTEMPTS == attempt + 1) {
+			m_nrofBelowScore++;
+		}
+	}
+
+	result[NROF_ROWS * NROF_COLS] = '\n';
+
+	m_times[slot] = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Marks a puzzle as generated and writes it, followed by the ones after it already generated, once all the
+ * puzzles before it are written
+ */
+void CSudokuGenerator::writeReady(const uint64_t index)
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+
+	m_ready[index % GENERATOR_WINDOW] = 1;
+
+	if (index != m_nrofPuzzles) {
+		return;
+	}
+
+	while ((m_nrofPuzzles < m_nrofRequested) && m_ready[m_nrofPuzzles % GENERATOR_WINDOW]) {
+
+		const uint32_t slot = (uint32_t)(m_nrofPuzzles % GENERATOR_WINDOW);
+		const char *result = &m_results[slot * (NROF_ROWS * NROF_COLS + 1)];
+
+		if (m_binary) {
+			m_archive.write(result);
+		}
+		else {
+			fwrite(result, 1, NROF_ROWS * NROF_COLS + 1, m_out);
+		}
+
+		m_latency.push_back(m_times[slot]);
+		m_ready[slot] = 0;
+		m_nrofPuzzles++;
+
+		if ((0 == (m_nrofPuzzles % GENERATOR_PROGRESS)) || (m_nrofPuzzles == m_nrofRequested)) {
+
+			if (false == m_binary) {
+				fflush(m_out);
+			}
+
+			printProgress(m_nrofRequested, std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count());
+		}
+	}
+
+	m_written.notify_all();
+}
+
+/**
+ * Prints on stderr, over the previous line, the number of puzzles generated so far and the throughput
+ */
+void CSudokuGenerator::printProgress(const uint64_t nrofPuzzles, const double seconds)
+{
+	std::cerr << std::fixed << std::setprecision(1)
+		<< "\rGenerated " << m_nrofPuzzles << " of " << nrofPuzzles << " puzzles: "
+		<< ((seconds > 0) ? m_nrofPuzzles / seconds : 0) << " puzzles/s" << std::flush;
+}
+
+/**
+ * Prints on stderr the number of puzzles generated, the throughput and the mean and p99 latency per puzzle
+ */
+void CSudokuGenerator::printSummary(const double seconds)
+{
+	double mean = 0;
+	double p99 = 0;
+
+	if (m_latency.size()) {
+
+		uint64_t total = 0;
+		for (std::vector<uint32_t>::iterator it = m_latency.begin(); it != m_latency.end(); ++it) {
+			total += *it;
+		}
+
+		mean = (double)total / m_latency.size();
+
+		std::vector<uint32_t>::iterator it99 = m_latency.begin() + (m_latency.size() * 99) / 100;
+		std::nth_element(m_latency.begin(), it99, m_latency.end());
+		p99 = *it99;
+	}
+
+	std::cerr << std::fixed << std::setprecision(1)
+		<< "\rGenerated " << m_nrofPuzzles << " puzzles in " << seconds << " s: "
+		<< ((seconds > 0) ? m_nrofPuzzles / seconds : 0) << " puzzles/s, "
+		<< "mean " << mean / 1000 << " ms, p99 " << p99 / 1000 << " ms" << std::endl;
+}
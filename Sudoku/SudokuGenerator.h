@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SudokuArchive.h"
+#include "SudokuGrid.h"
+#include "SudokuPool.h"
+#include "SudokuRater.h"
+
+
+// Puzzles generated ahead of the next one to be written, the size of the reorder buffer
+#define GENERATOR_WINDOW (4096)
+
+// Puzzles written between two lines of progress
+#define GENERATOR_PROGRESS (256)
+
+// Puzzles generated for each one written when they have to reach a minimum score, the last one is kept
+// and counted as below the score (the run then fails)
+#define GENERATOR_MAX_ATTEMPTS (1000)
+
+
+/**
+ * Generates a stream of puzzles of a difficulty level, each one with a single solution, writing
+ * them in line format (81 characters per line, see CSudokuGrid::writeLine). Progress and throughput
+ * figures are printed on stderr while generating. Optionally, puzzles that do not reach a minimum
+ * difficulty score are generated again (see GENERATOR_MAX_ATTEMPTS).
+ *
+ * Puzzles are generated by a pool of workers, each one with its own grid and random generator, taking
+ * the next puzzle of the sequence as soon as they are done with the previous one. The puzzles go to a
+ * reorder buffer and are written in order as soon as all the puzzles before them are, a worker only
+ * waits when it gets GENERATOR_WINDOW puzzles ahead of the next one to be written. The generator is
+ * seeded again for every puzzle from the seed of the run and the number
+ * of the puzzle, so the output only depends on the seed and not on the number of workers, and a
+ * sequence can be split in ranges of puzzles generated on different machines.
+ *
+ * The puzzles can also be written as a binary archive (see CSudokuArchive).
+ */
+class CSudokuGenerator
+{
+public:
+	CSudokuGenerator(const uint8_t level, const uint64_t seed, const uint32_t nrofThreads = 1, const uint8_t mask = MASK_LEVEL, const uint32_t nrofClues = 0, const uint32_t minScore = 0);
+	~CSudokuGenerator();
+
+	int run(const uint64_t first, const uint64_t nrofPuzzles, const std::string &fileName);
+	int run(const uint64_t first, const uint64_t nrofPuzzles, FILE *out);
+
+	void setBinary(const bool binary);
+
+private:
+	uint8_t m_level;
+	uint64_t m_seed;
+
+	// Clues of the puzzles (see MASK_LEVEL) and, without a mask, how many of them are kept
+	uint8_t m_mask;
+	uint32_t m_nrofClues;
+
+	// Puzzles rated below this score (see CSudokuRater) are generated again
+	uint32_t m_minScore;
+	CSudokuRater m_rater;
+
+	// Number of the first puzzle of the run within the sequence of the seed
+	uint64_t m_first;
+
+	CSudokuPool m_pool;
+
+	// Grid and random generator of each worker, reused for every puzzle
+	std::vector<CSudokuGrid> m_grids;
+	std::vector<std::mt19937> m_random;
+
+	// Reorder buffer: puzzle 'index' of the run goes to slot 'index % GENERATOR_WINDOW' (81 characters and
+	// end of line each) with the time it took, until all the puzzles before it are written
+	std::vector<char> m_results;
+	std::vector<uint8_t> m_ready;
+	std::vector<uint32_t> m_times;
+
+	// Next puzzle of the run taken by a worker, and the number of puzzles of the run
+	std::atomic<uint64_t> m_next;
+	uint64_t m_nrofRequested;
+
+	// Guards the reorder buffer and the output, raised whenever puzzles are written
+	std::mutex m_lock;
+	std::condition_variable m_written;
+
+	FILE *m_out;
+	std::chrono::steady_clock::time_point m_start;
+
+	// Whether the puzzles are written to an archive instead of text
+	bool m_binary;
+	CSudokuArchive m_archive;
+
+	// Number of puzzles of the run written so far
+	uint64_t m_nrofPuzzles;
+
+	// Puzzles of the run written below the minimum score after GENERATOR_MAX_ATTEMPTS attempts
+	std::atomic<uint64_t> m_nrofBelowScore;
+
+	// Time spent on each puzzle, in microseconds
+	std::vector<uint32_t> m_latency;
+
+private:
+	void generateStream(const uint32_t workerId);
+	void generatePuzzle(const uint32_t workerId, const uint64_t index);
+	void writeReady(const uint64_t index);
+	void printProgress(const uint64_t nrofPuzzles, const double seconds);
+	void printSummary(const double seconds);
+};
@@ -1,4 +1,10 @@
 #include "SudokuGrid.h"
+#include "SudokuCache.h"
+#include "SudokuCanonical.h"
+#include "SudokuConstraints.h"
+#include "SudokuDLX.h"
+#include "SudokuKernels.h"
+#include "SudokuPool.h"
 
 #include <iostream>
 #include <fstream>
@@ -9,11 +15,78 @@
 #include <cstdlib>
 #include <random>
 #include <chrono>   
+#include <cstring>
+#include <memory>
+#include <mutex>
 
 using namespace std;
 
+/**
+ * Looks for the canonical form of a puzzle in the cache, replacing the puzzle by the solution of the
+ * equivalent one found there. Otherwise the canonical form and its transformation are kept for the
+ * solution to be added, the canonical form is left empty if the puzzle has none
+ */
+static bool findCached(CSudokuCache &cache, char *line, char *canonical, transform_t &transform)
+{
+	// Reused by every grid of a thread
+	static thread_local CSudokuCanonical canonicalizer;
+
+	if (false == canonicalizer.canonicalize(line, canonical, transform)) {
+
+		canonical[0] = 0;
+		return false;
+	}
+
+	char canonicalSolution[NROF_ROWS * NROF_COLS];
+
+	if (false == cache.find(canonical, canonicalSolution)) {
+		return false;
+	}
+
+	CSudokuCanonical::revert(transform, canonicalSolution, line);
+
+	return true;
+}
+
+/**
+ * Pool of the parallel search, one per calling thread so that searches started by several threads run
+ * side by side. Its threads are only started again when a search asks for another number of them
+ */
+static CSudokuPool &searchPool(const uint32_t nrofThreads)
+{
+	static thread_local std::unique_ptr<CSudokuPool> pool;
+
+	if ((nullptr == pool) || (pool->getNrofThreads() != nrofThreads)) {
+		pool.reset(new CSudokuPool(nrofThreads));
+	}
+
+	return *pool;
+}
+
+/**
+ * Fisher-Yates shuffle drawing from the generator directly, so the same seed gives the same order with 
+ * every standard library (std::shuffle is free to use the generator in other ways)
+ */
+template <typename T>
+static void shuffle(std::vector<T> &items, std::mt19937 &random)
+{
+	for (size_t id = items.size(); id > 1; id--) {
+
+		const size_t other = (size_t)(((uint64_t)random() * id) >> 32);
+		std::swap(items[id - 1], items[other]);
+	}
+}
+
 CSudokuGrid::CSudokuGrid()
+	: m_logic(LOGIC_NONE), m_constraints(nullptr), m_cache(nullptr), m_trail(nullptr), m_trailTop(0), m_cancel(nullptr), m_random(nullptr)
+{
+	initGrid();
+}
+
+CSudokuGrid::CSudokuGrid(const CSudokuGrid &grid)
+	: m_logic(LOGIC_NONE), m_constraints(nullptr), m_cache(nullptr), m_trail(nullptr), m_trailTop(0), m_cancel(nullptr), m_random(nullptr)
 {
+	*this = grid;
 }
 
 CSudokuGrid::~CSudokuGrid()
@@ -34,6 +107,8 @@ bool CSudokuGrid::readGrid(const std::string & fileName)
 
 	if (file.is_open()) {
 
+		initGrid();
+
 		std::string line;
 
 		while (getline(file, line) && (rowId < 9)) {
@@ -45,10 +120,7 @@ bool CSudokuGrid::readGrid(const std::string & fileName)
 			while ((iss >> value) && (colId < 9)) {
 				// '1' = 49, '9' = 57
 				if ((value >= 49) && (value <= 57)) {
-					pushBack(rowId, colId, value);
-				}
-				else {
-					notAssigned(rowId, colId);
+					assign(rowId, colId, value);
 				}
 
 				colId++;
@@ -77,19 +149,66 @@ bool CSudokuGrid::readGrid(const std::string & fileName)
 }
 
 /**
- * Inserts a new value at the end of a cell list
+ * Reads a Sudoku from a single line of text, as used by batch files.
+ *
+ * The line holds the 81 cells of the grid row after row. Each character is either a number (1-9) or some 
+ * other character to symbolize an empty box. Nothing is printed, so it can be used for millions of puzzles.
  */
-void CSudokuGrid::pushBack(uint16_t rowId, uint16_t colId, char value)
+bool CSudokuGrid::readLine(const char *line, const size_t length)
 {
-	assert(rowId < NROF_ROWS);
-	assert(colId < NROF_COLS);
-	assert(value >= 49); assert(value <= 57); // '1' = 49, '9' = 57
+	assert(line);
+
+	if (length < (NROF_ROWS * NROF_COLS)) {
+		return false;
+	}
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+
+			const char value = line[rowId * NROF_COLS + colId];
+
+			// '1' = 49, '9' = 57
+			m_cells[rowId][colId] = ((value >= 49) && (value <= 57)) ? valToBit(value) : ALL_CANDIDATES;
+		}
+	}
+
+	updateMasks();
+
+	return true;
+}
+
+/**
+ * Takes the candidates of every cell from a grid partially solved somewhere else (see CSudokuLanes)
+ */
+void CSudokuGrid::readCandidates(const uint16_t cells[NROF_ROWS][NROF_COLS])
+{
+	memcpy(m_cells, cells, sizeof(m_cells));
+
+	updateMasks();
+}
+
+/**
+ * Writes the grid as a single line of 81 characters (no end of line). Cells not assigned, or hidden by the 
+ * mask of the level (see print), are written as '.'
+ */
+void CSudokuGrid::writeLine(char *line, const uint8_t level) const
+{
+	assert(line);
+	assert(level <= NROF_LEVELS);
 
-	m_cells[rowId][colId].push_back(value);
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+
+			const uint16_t cell = m_cells[rowId][colId];
+			line[rowId * NROF_COLS + colId] = ((1 == bitCount(cell)) && GEN_MASK[level][rowId][colId]) ? bitToVal(cell) : 46; // '.' = 46
+		}
+	}
 }
 
 /**
- * Reduces list of a cell to its first value
+ * Reduces the candidates of a cell to the given value
  */
 void CSudokuGrid::assign(const uint16_t rowId, const uint16_t colId, const char value)
 {
@@ -97,50 +216,150 @@ void CSudokuGrid::assign(const uint16_t rowId, const uint16_t colId, const char
 	assert(colId < NROF_COLS);
 	assert(value >= 49); assert(value <= 57); // '1' = 49, '9' = 57
 
-	m_cells[rowId][colId].assign(1, value);
+	if (1 == bitCount(m_cells[rowId][colId])) {
+
+		// Overwriting an assigned value, masks need to be rebuilt. This cannot be undone
+		assert(nullptr == m_trail);
+
+		m_cells[rowId][colId] = valToBit(value);
+		updateMasks();
+	}
+	else {
+		setCell(rowId, colId, valToBit(value));
+	}
 }
 
 /**
- * Inserts all possible values in the cell list
+ * Stores the new candidates of a cell. When only one candidate remains, the value is 
+ * registered as assigned within the row, column and box of the cell
  */
-void CSudokuGrid::notAssigned(const uint16_t rowId, const uint16_t colId)
+void CSudokuGrid::setCell(const uint16_t rowId, const uint16_t colId, const uint16_t mask)
 {
 	assert(rowId < NROF_ROWS);
 	assert(colId < NROF_COLS);
 
-	m_cells[rowId][colId].assign(from1to9.begin(), from1to9.end());
+	if (m_cells[rowId][colId] == mask) {
+		return;
+	}
+
+	const uint16_t bandId = rowId / (NROF_ROWS / NROF_BANDS);
+	const uint16_t stackId = colId / (NROF_COLS / NROF_STACKS);
+
+	store(m_cells[rowId][colId], mask);
+
+	// The row, column and box of the cell need to be analysed again
+	m_dirty |= (1 << rowId) | (1 << (NROF_ROWS + colId)) | (1 << (NROF_ROWS + NROF_COLS + bandId * NROF_STACKS + stackId));
+
+	// And so do the constraints of the variant that depend on it
+	if (m_constraints) {
+		m_dirty |= m_constraints->getGroups(rowId, colId);
+	}
+
+	if (0 == mask) {
+
+		store(m_conflict, 1);
+	}
+	else if (1 == bitCount(mask)) {
+
+		uint16_t &boxMask = m_boxMask[bandId][stackId];
+
+		if ((m_rowMask[rowId] | m_colMask[colId] | boxMask) & mask) {
+			store(m_conflict, 1);
+		}
+
+		store(m_rowMask[rowId], m_rowMask[rowId] | mask);
+		store(m_colMask[colId], m_colMask[colId] | mask);
+		store(boxMask, boxMask | mask);
+	}
+}
+
+/**
+ * Writes a word of the grid state. While searching, the previous value is recorded in the trail
+ */
+inline void CSudokuGrid::store(uint16_t &word, const uint16_t value)
+{
+	if (m_trail && (word != value)) {
+
+		assert(m_trailTop < TRAIL_SIZE);
+
+		m_trail[m_trailTop].word = &word;
+		m_trail[m_trailTop].value = word;
+		m_trailTop++;
+	}
+
+	word = value;
+}
+
+/**
+ * Restores the grid state to the moment the trail had 'trailMark' entries
+ */
+void CSudokuGrid::undo(const uint32_t trailMark)
+{
+	assert(m_trail);
+	assert(trailMark <= m_trailTop);
+
+	while (m_trailTop > trailMark) {
+
+		m_trailTop--;
+		*m_trail[m_trailTop].word = m_trail[m_trailTop].value;
+	}
+}
+
+/**
+ * Rebuilds the masks of assigned values of all rows, columns and boxes from the cells, in a single scan 
+ * of the grid (see scanUnits). All the units need to be analysed again
+ */
+void CSudokuGrid::updateMasks()
+{
+	assert(nullptr == m_trail);
+
+	unitScan_t scan;
+	scanUnits(m_cells, scan);
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+		m_rowMask[rowId] = scan.rows[rowId];
+	}
+
+	for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+		m_colMask[colId] = scan.cols[colId];
+	}
+
+	for (uint16_t bandId = 0; bandId < NROF_BANDS; bandId++) {
+
+		for (uint16_t stackId = 0; stackId < NROF_STACKS; stackId++) {
+			m_boxMask[bandId][stackId] = scan.boxes[bandId * NROF_STACKS + stackId];
+		}
+	}
+
+	m_conflict = scan.valid ? 0 : 1;
+	m_dirty = ALL_UNITS | (m_constraints ? m_constraints->getAllGroups() : 0);
 }
 
 /**
- * Removes candidates equal to already assigned values within a row recursively
+ * Removes candidates equal to already assigned values within a row, until no more candidates can be removed
  */
 uint32_t CSudokuGrid::checkRow(const uint16_t rowId)
 {
 	assert(rowId < NROF_ROWS);
 	
 	uint32_t result = 0;
+	uint16_t assigned;
 
-	std::vector<char> val;
-	std::vector<cellPos_t> candPos;
+	do {
+		assigned = m_rowMask[rowId];
 
-	for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+		for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
 
-		if (1 == m_cells[rowId][colId].size()) {
-			val.push_back(m_cells[rowId][colId].front());
-		}
-		else {
-			candPos.push_back({rowId, colId});
-		}
-	}
+			const uint16_t cell = m_cells[rowId][colId];
 
-	if (NROF_COLS == val.size())
-		return 0;
+			if ((1 < bitCount(cell)) && (cell & m_rowMask[rowId])) {
 
-	result = remove(val, candPos);
+				setCell(rowId, colId, cell & ~m_rowMask[rowId]);
+				result++;
+			}
+		}
 
-	if (result) {
-		result += checkRow(rowId);
-	}
+	} while (assigned != m_rowMask[rowId]);
 
 	return result;
 }
@@ -164,35 +383,30 @@ uint32_t CSudokuGrid::checkRows(const uint16_t rowFirstId, const uint16_t rowLas
 }
 
 /**
- * Removes candidates equal to already assigned values within a column recursively
+ * Removes candidates equal to already assigned values within a column, until no more candidates can be removed
  */
 uint32_t CSudokuGrid::checkColumn(const uint16_t colId)
 {
 	assert(colId < NROF_COLS);
 	
 	uint32_t result = 0;
+	uint16_t assigned;
 
-	std::vector<char> val;
-	std::vector<cellPos_t> candPos;
+	do {
+		assigned = m_colMask[colId];
 
-	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+		for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
 
-		if (1 == m_cells[rowId][colId].size()) {
-			val.push_back(m_cells[rowId][colId].front());
-		}
-		else {
-			candPos.push_back({rowId, colId});
-		}
-	}
+			const uint16_t cell = m_cells[rowId][colId];
 
-	if (NROF_ROWS == val.size())
-		return 0;
+			if ((1 < bitCount(cell)) && (cell & m_colMask[colId])) {
 
-	result = remove(val, candPos);
+				setCell(rowId, colId, cell & ~m_colMask[colId]);
+				result++;
+			}
+		}
 
-	if (result) {
-		result += checkColumn(colId);
-	}
+	} while (assigned != m_colMask[colId]);
 
 	return result;
 }
@@ -216,7 +430,7 @@ uint32_t CSudokuGrid::checkColumns(const uint16_t colFirstId, const uint16_t col
 }
 
 /**
- * Removes candidates equal to already assigned values within a box recursively
+ * Removes candidates equal to already assigned values within a box, until no more candidates can be removed
  */
 uint32_t CSudokuGrid::checkBox(const uint16_t bandId, const uint16_t stackId)
 {
@@ -224,33 +438,27 @@ uint32_t CSudokuGrid::checkBox(const uint16_t bandId, const uint16_t stackId)
 	assert(stackId < NROF_STACKS);
 
 	uint32_t result = 0;
+	uint16_t assigned;
 
-	std::vector<char> val;
-	std::vector<cellPos_t> candPos;
+	do {
+		assigned = m_boxMask[bandId][stackId];
 
-	for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
+		for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
 
-		for (uint16_t colId = 0; colId < (NROF_COLS / NROF_STACKS); colId++) {
+			for (uint16_t colId = 0; colId < (NROF_COLS / NROF_STACKS); colId++) {
 
-			const cellPos_t cellPos{(uint16_t)(bandId * (NROF_ROWS / NROF_BANDS) + rowId), (uint16_t)(stackId * (NROF_COLS / NROF_STACKS) + colId)};
+				const cellPos_t cellPos{(uint16_t)(bandId * (NROF_ROWS / NROF_BANDS) + rowId), (uint16_t)(stackId * (NROF_COLS / NROF_STACKS) + colId)};
+				const uint16_t cell = m_cells[cellPos.rowId][cellPos.colId];
 
-			if (1 == m_cells[cellPos.rowId][cellPos.colId].size()) {
-				val.push_back(m_cells[cellPos.rowId][cellPos.colId].front());
-			}
-			else {
-				candPos.push_back({ cellPos.rowId, cellPos.colId });
+				if ((1 < bitCount(cell)) && (cell & m_boxMask[bandId][stackId])) {
+
+					setCell(cellPos.rowId, cellPos.colId, cell & ~m_boxMask[bandId][stackId]);
+					result++;
+				}
 			}
 		}
-	}
-
-	if (NROF_ROWS == val.size())
-		return 0;
-
-	result = remove(val, candPos);
 
-	if (result) {
-		result += checkBox(bandId, stackId);
-	}
+	} while (assigned != m_boxMask[bandId][stackId]);
 
 	return result;
 }
@@ -283,41 +491,114 @@ uint32_t CSudokuGrid::checkBoxes(const uint16_t bandFirstId, const uint16_t band
 }
 
 /**
- * Also known as 'scanning'. Searches for a cell within the given box that contains a candidate that 
- * only appears one in the box but it is not aasigned yet
+ * Cell at position 'slot' (0 to 8) of a unit (see NROF_UNITS)
+ */
+static inline void unitCell(const uint32_t unitId, const uint16_t slot, uint16_t &rowId, uint16_t &colId)
+{
+	if (unitId < NROF_ROWS) {
+
+		rowId = (uint16_t)unitId;
+		colId = slot;
+	}
+	else if (unitId < (NROF_ROWS + NROF_COLS)) {
+
+		rowId = slot;
+		colId = (uint16_t)(unitId - NROF_ROWS);
+	}
+	else {
+
+		const uint16_t boxId = (uint16_t)(unitId - NROF_ROWS - NROF_COLS);
+
+		rowId = (boxId / NROF_STACKS) * (NROF_ROWS / NROF_BANDS) + slot / (NROF_COLS / NROF_STACKS);
+		colId = (boxId % NROF_STACKS) * (NROF_COLS / NROF_STACKS) + slot % (NROF_COLS / NROF_STACKS);
+	}
+}
+
+/**
+ * Hidden singles within a row, see hiddenSingle
+ */
+uint32_t CSudokuGrid::hiddenSingleRow(const uint16_t rowId)
+{
+	assert(rowId < NROF_ROWS);
+
+	return hiddenSingle(rowId);
+}
+
+/**
+ * Hidden singles within a column, see hiddenSingle
+ */
+uint32_t CSudokuGrid::hiddenSingleColumn(const uint16_t colId)
+{
+	assert(colId < NROF_COLS);
+
+	return hiddenSingle(NROF_ROWS + colId);
+}
+
+/**
+ * Also known as 'scanning', hidden singles within a box, see hiddenSingle
  */
 uint32_t CSudokuGrid::hiddenSingleBox(const uint16_t bandId, const uint16_t stackId)
 {
 	assert(bandId < NROF_BANDS);
 	assert(stackId < NROF_STACKS);
 
+	return hiddenSingle(NROF_ROWS + NROF_COLS + bandId * NROF_STACKS + stackId);
+}
+
+/**
+ * Hidden singles within a unit (see NROF_UNITS). A value not assigned yet that is a candidate of only one
+ * cell of the unit is assigned to that cell. A value that is neither assigned nor a candidate of any cell
+ * is a conflict
+ */
+uint32_t CSudokuGrid::hiddenSingle(const uint32_t unitId)
+{
+	assert(unitId < NROF_UNITS);
+
 	uint32_t result = 0;
 
-	std::list<char> cand;
-	std::vector<cellPos_t> candPos;
+	uint16_t rowIds[NROF_VALUES], colIds[NROF_VALUES];
 
-	sumBox(bandId, stackId, cand, candPos);
+	// Candidates of the non assigned cells, and the ones that appear in more than one of them
+	uint16_t cand = 0, candTwice = 0;
 
-	if (0 == cand.size())
-		return 0;
+	for (uint16_t slot = 0; slot < NROF_VALUES; slot++) {
 
-	std::list<char> candUnique = cand;
-	candUnique.sort();
-	candUnique.unique();
+		unitCell(unitId, slot, rowIds[slot], colIds[slot]);
 
-	for (std::list<char>::iterator it = candUnique.begin(); it != candUnique.end(); ++it) {
-	
-		int count = (int)std::count(cand.begin(), cand.end(), *it);
-		if (1 == count) {
+		const uint16_t cell = m_cells[rowIds[slot]][colIds[slot]];
 
-			const int distance = (int)std::distance(cand.begin(), std::find(cand.begin(), cand.end(), *it));
-			const cellPos_t cellPos = candPos[distance];
+		if (1 < bitCount(cell)) {
 
-			m_cells[cellPos.rowId][cellPos.colId].clear();
-			m_cells[cellPos.rowId][cellPos.colId].push_back(*it);
+			candTwice |= cand & cell;
+			cand |= cell;
+		}
+	}
 
-			result++;
+	// Values already assigned within the unit
+	const uint16_t placed = (unitId < NROF_ROWS) ? m_rowMask[unitId] : (unitId < (NROF_ROWS + NROF_COLS)) ? m_colMask[unitId - NROF_ROWS]
+		: m_boxMask[(unitId - NROF_ROWS - NROF_COLS) / NROF_STACKS][(unitId - NROF_ROWS - NROF_COLS) % NROF_STACKS];
+
+	if (ALL_CANDIDATES & ~(cand | placed)) {
+
+		store(m_conflict, 1);
+		return 0;
+	}
+
+	const uint16_t hidden = cand & ~candTwice & ~placed;
+
+	for (uint16_t slot = 0; hidden && (slot < NROF_VALUES); slot++) {
+
+		const uint16_t cell = m_cells[rowIds[slot]][colIds[slot]];
+
+		if ((1 == bitCount(cell)) || (0 == (cell & hidden))) {
+			continue;
 		}
+
+		// A cell cannot be the only place for two different values
+		const uint16_t mask = cell & hidden;
+		setCell(rowIds[slot], colIds[slot], (1 == bitCount(mask)) ? mask : 0);
+
+		result++;
 	}
 
 	return result;
@@ -335,45 +616,54 @@ uint32_t CSudokuGrid::checkBand(const uint16_t bandId)
 
 	for (uint16_t stackId = 0; stackId < NROF_STACKS; stackId++) {
 
-		uint32_t resultStack = 0;
+		uint32_t resultStack = pointRow(bandId, stackId);
+
+		if (resultStack) {
+
+			resultStack += checkBox(bandId, (stackId + 1) % 3);
+			resultStack += checkBox(bandId, (stackId + 2) % 3);
+		}
 
-		std::list<char> cand;
-		std::vector<cellPos_t> candPos;
+		result += resultStack;
+	}
 
-		sumBox(bandId, stackId, cand, candPos);
+	return result;
+}
 
-		std::list<char> candUnique = cand;
-		candUnique.sort();
-		candUnique.unique();
+/**
+ * Intersection of a box with the rows of its band. The candidates of the box that only appear 
+ * in one of its rows are removed from the cells of that row in the other boxes of the band
+ */
+uint32_t CSudokuGrid::pointRow(const uint16_t bandId, const uint16_t stackId)
+{
+	assert(bandId < NROF_BANDS);
+	assert(stackId < NROF_STACKS);
 
-		for (std::list<char>::iterator it = candUnique.begin(); it != candUnique.end(); ++it) {
+	uint32_t result = 0;
 
-			std::list<uint16_t> candRowId;
-			std::list<char>::iterator candIt = cand.begin();
+	// Candidates of the non assigned cells of each row of the box
+	uint16_t rowCand[NROF_ROWS / NROF_BANDS] = { 0 };
 
-			do {
-				candIt = std::find(candIt, cand.end(), *it);
-				if (cand.end() == candIt)
-					break;
+	for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
 
-				const int distance = (int)std::distance(cand.begin(), candIt);
-				candRowId.push_back(candPos[distance].rowId);
+		for (uint16_t colId = 0; colId < (NROF_COLS / NROF_STACKS); colId++) {
 
-			} while (++candIt != cand.end());
+			const uint16_t cell = m_cells[bandId * (NROF_ROWS / NROF_BANDS) + rowId][stackId * (NROF_COLS / NROF_STACKS) + colId];
 
-			candRowId.unique();
-			if (1 == candRowId.size()) {				
-				resultStack += removeInRow(candRowId.front(), stackId, *it);
+			if (1 < bitCount(cell)) {
+				rowCand[rowId] |= cell;
 			}
 		}
+	}
 
-		if (resultStack) {
+	for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
 
-			resultStack += checkBox(bandId, (stackId + 1) % 3);
-			resultStack += checkBox(bandId, (stackId + 2) % 3);
-		}
+		// Candidates of the box that only appear in this row
+		const uint16_t mask = rowCand[rowId] & ~rowCand[(rowId + 1) % 3] & ~rowCand[(rowId + 2) % 3] & ~m_boxMask[bandId][stackId];
 
-		resultStack += result;
+		if (mask) {
+			result += removeInRow(bandId * (NROF_ROWS / NROF_BANDS) + rowId, stackId, mask);
+		}
 	}
 
 	return result;
@@ -408,37 +698,7 @@ uint32_t CSudokuGrid::checkStack(const uint16_t stackId)
 
 	for (uint16_t bandId = 0; bandId < NROF_BANDS; bandId++) {
 
-		uint32_t resultBand = 0;
-
-		std::list<char> cand;
-		std::vector<cellPos_t> candPos;
-
-		sumBox(bandId, stackId, cand, candPos);
-
-		std::list<char> candUnique = cand;
-		candUnique.sort();
-		candUnique.unique();
-
-		for (std::list<char>::iterator it = candUnique.begin(); it != candUnique.end(); ++it) {
-
-			std::list<uint16_t> candColId;
-			std::list<char>::iterator candIt = cand.begin();
-
-			do {
-				candIt = std::find(candIt, cand.end(), *it);
-				if (cand.end() == candIt)
-					break;
-
-				const int distance = (int)std::distance(cand.begin(), candIt);
-				candColId.push_back(candPos[distance].colId);
-
-			} while (++candIt != cand.end());
-
-			candColId.unique();
-			if (1 == candColId.size()) {
-				resultBand += removeInCol(candColId.front(), bandId, *it);
-			}
-		}
+		uint32_t resultBand = pointCol(bandId, stackId);
 
 		if (resultBand) {
 
@@ -446,20 +706,59 @@ uint32_t CSudokuGrid::checkStack(const uint16_t stackId)
 			resultBand += checkBox((bandId + 2) % 3, stackId);
 		}
 
-		resultBand += result;
+		result += resultBand;
 	}
 
 	return result;
 }
 
 /**
- * Intersection applied to all the stacks of the grid sequentially
+ * Intersection of a box with the columns of its stack. The candidates of the box that only appear 
+ * in one of its columns are removed from the cells of that column in the other boxes of the stack
  */
-uint32_t CSudokuGrid::checkStacks(const uint16_t stackFirstId, const uint16_t stackLastId)
+uint32_t CSudokuGrid::pointCol(const uint16_t bandId, const uint16_t stackId)
 {
-	assert(stackFirstId < NROF_STACKS);
-	assert(stackLastId < NROF_STACKS);
-	assert(stackFirstId < stackLastId);
+	assert(bandId < NROF_BANDS);
+	assert(stackId < NROF_STACKS);
+
+	uint32_t result = 0;
+
+	// Candidates of the non assigned cells of each column of the box
+	uint16_t colCand[NROF_COLS / NROF_STACKS] = { 0 };
+
+	for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
+
+		for (uint16_t colId = 0; colId < (NROF_COLS / NROF_STACKS); colId++) {
+
+			const uint16_t cell = m_cells[bandId * (NROF_ROWS / NROF_BANDS) + rowId][stackId * (NROF_COLS / NROF_STACKS) + colId];
+
+			if (1 < bitCount(cell)) {
+				colCand[colId] |= cell;
+			}
+		}
+	}
+
+	for (uint16_t colId = 0; colId < (NROF_COLS / NROF_STACKS); colId++) {
+
+		// Candidates of the box that only appear in this column
+		const uint16_t mask = colCand[colId] & ~colCand[(colId + 1) % 3] & ~colCand[(colId + 2) % 3] & ~m_boxMask[bandId][stackId];
+
+		if (mask) {
+			result += removeInCol(stackId * (NROF_COLS / NROF_STACKS) + colId, bandId, mask);
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Intersection applied to all the stacks of the grid sequentially
+ */
+uint32_t CSudokuGrid::checkStacks(const uint16_t stackFirstId, const uint16_t stackLastId)
+{
+	assert(stackFirstId < NROF_STACKS);
+	assert(stackLastId < NROF_STACKS);
+	assert(stackFirstId < stackLastId);
 
 	uint32_t result = 0;
 
@@ -470,241 +769,1403 @@ uint32_t CSudokuGrid::checkStacks(const uint16_t stackFirstId, const uint16_t st
 }
 
 /**
- * Performs all previous analysis (basic) techniques in other to remove candidates from the cells iterativelly
- * and checks for the validity of the grid
+ * Masks of 9 bits with 'size' bits set, from 2 to 4
  */
-int CSudokuGrid::checkGrid(uint32_t &iter, const bool show)
+static const std::vector<uint16_t> &subsetMasks(const uint32_t size)
 {
-	int retVal = VALID_NOT_SOLVED;
-	uint32_t result;
+	assert((size >= 2) && (size <= 4));
 
-	do {
-		result = 0;
+	static std::vector<uint16_t> masks[5];
+	static std::once_flag once;
 
-		result += checkRows();
-		result += checkColumns();
-		result += checkBoxes();
-		result += checkBands();
-		result += checkStacks();
+	std::call_once(once, []() {
 
-		iter++;
+		for (uint16_t mask = 0; mask <= ALL_CANDIDATES; mask++) {
 
-	} while (result);
+			const uint32_t count = bitCount(mask);
 
-	const bool solved = isSolved();
+			if ((count >= 2) && (count <= 4)) {
+				masks[count].push_back(mask);
+			}
+		}
+	});
 
-	if (solved) {
+	return masks[size];
+}
 
-		retVal = VALID_SOLVED;
+/**
+ * Looks for 'size' of the 'items' (bit masks of up to 9 bits, 0 for the items left out) whose bits are 
+ * all within the same 'size' bits. Returns the mask of the items found and sets 'bits' to their bits
+ */
+static uint16_t findSubset(const uint16_t items[9], const uint32_t size, const std::vector<uint16_t> &masks, std::vector<uint16_t>::const_iterator &it, uint16_t &bits)
+{
+	uint16_t universe = 0;
 
-		if (show) {
+	for (uint16_t itemId = 0; itemId < 9; itemId++) {
+		universe |= items[itemId];
+	}
 
-			std::cout << "Puzzle solved!";
-			print();
+	for (; it != masks.end(); ++it) {
+
+		if (*it & ~universe) {
+			continue;
+		}
+
+		uint16_t inside = 0;
+
+		for (uint16_t itemId = 0; itemId < 9; itemId++) {
+
+			if (items[itemId] && (0 == (items[itemId] & ~*it))) {
+				inside |= (1 << itemId);
+			}
+		}
+
+		if (size == bitCount(inside)) {
+
+			bits = *it++;
+			return inside;
 		}
 	}
-	else {
 
-		if (false == IsGridValid()) {
-			retVal = NOT_VALID;
+	return 0;
+}
+
+/**
+ * Naked pairs, triples and quads. When 'size' cells of a unit have no candidates but the same 'size' 
+ * values, these values can be removed from the rest of the cells of the unit
+ */
+uint32_t CSudokuGrid::nakedSubset(const uint32_t unitId, const uint32_t size)
+{
+	assert(unitId < NROF_UNITS);
+
+	uint32_t result = 0;
+
+	uint16_t rowIds[NROF_VALUES], colIds[NROF_VALUES];
+	uint16_t cells[NROF_VALUES];
+	uint32_t nrofOpen = 0;
+
+	for (uint16_t slot = 0; slot < NROF_VALUES; slot++) {
+
+		unitCell(unitId, slot, rowIds[slot], colIds[slot]);
+
+		const uint16_t cell = m_cells[rowIds[slot]][colIds[slot]];
+		cells[slot] = (1 < bitCount(cell)) ? cell : 0;
+
+		nrofOpen += (0 != cells[slot]);
+	}
+
+	// A subset of all the open cells removes nothing
+	if (nrofOpen <= size) {
+		return 0;
+	}
+
+	const std::vector<uint16_t> &masks = subsetMasks(size);
+	std::vector<uint16_t>::const_iterator it = masks.begin();
+	uint16_t values;
+
+	for (uint16_t inside; 0 != (inside = findSubset(cells, size, masks, it, values)); ) {
+
+		for (uint16_t slot = 0; slot < NROF_VALUES; slot++) {
+
+			if (cells[slot] && (0 == (inside & (1 << slot))) && (cells[slot] & values)) {
+
+				cells[slot] &= ~values;
+				setCell(rowIds[slot], colIds[slot], cells[slot]);
+				result++;
+			}
 		}
 	}
 
-	return retVal;
+	return result;
 }
 
 /**
- * Solves the Sudoku grid first by trying to use the analysis (basic) techniques. In case these do not solve the grid,
- * all possible combinations are checked in a brute force approach that finally gives the solution to the grid
+ * Hidden pairs, triples and quads. When 'size' values of a unit can only go in the same 'size' cells, the 
+ * rest of the candidates can be removed from these cells
  */
-int CSudokuGrid::solve(uint32_t &iter, const bool show)
+uint32_t CSudokuGrid::hiddenSubset(const uint32_t unitId, const uint32_t size)
 {
-	iter = 0;
+	assert(unitId < NROF_UNITS);
 
-	int retVal = checkGrid(iter, show);
+	uint32_t result = 0;
 
-	if (VALID_NOT_SOLVED == retVal) {
-		retVal = search(iter, show);
+	uint16_t rowIds[NROF_VALUES], colIds[NROF_VALUES];
+	uint16_t cells[NROF_VALUES];
+
+	// Cells of the unit where each value still fits, and values already assigned
+	uint16_t places[NROF_VALUES] = { 0 };
+	uint16_t assigned = 0;
+	uint32_t nrofOpen = 0;
+
+	for (uint16_t slot = 0; slot < NROF_VALUES; slot++) {
+
+		unitCell(unitId, slot, rowIds[slot], colIds[slot]);
+
+		cells[slot] = m_cells[rowIds[slot]][colIds[slot]];
+
+		if (1 == bitCount(cells[slot])) {
+
+			assigned |= cells[slot];
+			continue;
+		}
+
+		nrofOpen++;
+
+		for (uint16_t mask = cells[slot]; mask; mask &= (mask - 1)) {
+			places[bitIndex(mask)] |= (1 << slot);
+		}
 	}
 
-	return retVal;
+	for (uint16_t mask = assigned; mask; mask &= (mask - 1)) {
+		places[bitIndex(mask)] = 0;
+	}
+
+	if (nrofOpen <= size) {
+		return 0;
+	}
+
+	const std::vector<uint16_t> &masks = subsetMasks(size);
+	std::vector<uint16_t>::const_iterator it = masks.begin();
+	uint16_t slots;
+
+	for (uint16_t values; 0 != (values = findSubset(places, size, masks, it, slots)); ) {
+
+		for (uint16_t mask = slots; mask; mask &= (mask - 1)) {
+
+			const uint16_t slot = (uint16_t)bitIndex(mask);
+
+			if (cells[slot] & ~values) {
+
+				cells[slot] &= values;
+				setCell(rowIds[slot], colIds[slot], cells[slot]);
+				result++;
+			}
+		}
+	}
+
+	return result;
 }
 
 /**
- * Verifies if the Sudoku grid is solved
+ * X-Wing (size 2) and Swordfish (size 3). When a value can only go in the same 'size' columns within 'size' 
+ * rows, it can be removed from these columns in the rest of the rows. The same with rows and columns swapped
  */
-bool CSudokuGrid::isSolved()
+uint32_t CSudokuGrid::fish(const uint32_t size, const bool byRow)
 {
-	bool result = true;
+	assert((size >= 2) && (size <= 3));
 
-	for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+	uint32_t result = 0;
 
-		for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
-			
-			if (1 < m_cells[rowId][colId].size()) {
-				
-				return false;
+	const std::vector<uint16_t> &masks = subsetMasks(size);
+
+	for (uint16_t valId = 0; valId < NROF_VALUES; valId++) {
+
+		const uint16_t bit = (uint16_t)(1 << valId);
+
+		// Columns (or rows) of each row (or column) where the value still fits, and the ones where it is assigned
+		uint16_t places[NROF_ROWS] = { 0 };
+		uint16_t assigned = 0;
+
+		for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+			for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+
+				const uint16_t cell = m_cells[rowId][colId];
+				const uint16_t lineId = byRow ? rowId : colId;
+
+				if (bit == cell) {
+					assigned |= (1 << lineId);
+				}
+				else if (cell & bit) {
+					places[lineId] |= (1 << (byRow ? colId : rowId));
+				}
+			}
+		}
+
+		for (uint16_t mask = assigned; mask; mask &= (mask - 1)) {
+			places[bitIndex(mask)] = 0;
+		}
+
+		std::vector<uint16_t>::const_iterator it = masks.begin();
+		uint16_t lines;
+
+		for (uint16_t inside; 0 != (inside = findSubset(places, size, masks, it, lines)); ) {
+
+			for (uint16_t lineId = 0; lineId < NROF_ROWS; lineId++) {
+
+				if ((inside & (1 << lineId)) || (0 == (places[lineId] & lines))) {
+					continue;
+				}
+
+				for (uint16_t mask = places[lineId] & lines; mask; mask &= (mask - 1)) {
+
+					const uint16_t otherId = (uint16_t)bitIndex(mask);
+					const uint16_t rowId = byRow ? lineId : otherId;
+					const uint16_t colId = byRow ? otherId : lineId;
+
+					setCell(rowId, colId, m_cells[rowId][colId] & ~bit);
+					result++;
+				}
+
+				places[lineId] &= ~lines;
 			}
 		}
 	}
-	return IsGridValid();
+
+	return result;
 }
 
 /**
- * Prints the Sudoku grid layout in boxes
+ * Enables the advanced techniques (LOGIC_ flags) applied by checkGrid. All of them are disabled by default
  */
-int CSudokuGrid::print(const uint8_t level)
+void CSudokuGrid::setLogic(const uint32_t logic)
 {
-	assert(level <= NROF_LEVELS);
+	m_logic = logic & LOGIC_ALL;
+}
 
-	std::cout << endl;
-	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+/**
+ * Advanced techniques enabled
+ */
+uint32_t CSudokuGrid::getLogic() const
+{
+	return m_logic;
+}
 
-		if (0 == (rowId % 3)) {
-			std::cout << endl;
+/**
+ * Tries the advanced techniques enabled, from the simplest to the hardest, until one of them removes any 
+ * candidate. Returns the number of changes, the basic techniques are to be applied again on them
+ */
+uint32_t CSudokuGrid::checkLogic()
+{
+	for (uint32_t size = 2; size <= 4; size++) {
+
+		// Flags of the naked and the hidden subsets of this size
+		const uint32_t naked = LOGIC_NAKED_PAIRS << (2 * (size - 2));
+		const uint32_t hidden = LOGIC_HIDDEN_PAIRS << (2 * (size - 2));
+
+		for (uint32_t unitId = 0; (unitId < NROF_UNITS) && (m_logic & (naked | hidden)); unitId++) {
+
+			uint32_t result = 0;
+
+			if (m_logic & naked) {
+				result = nakedSubset(unitId, size);
+			}
+
+			// The basic techniques need to run before the hidden subsets see the values just assigned
+			if ((0 == result) && (m_logic & hidden)) {
+				result = hiddenSubset(unitId, size);
+			}
+
+			if (result) {
+				return result;
+			}
 		}
+	}
 
-		for (uint16_t stackId = 0; stackId < NROF_STACKS; stackId++) {
+	for (uint32_t size = 2; size <= 3; size++) {
 
-			std::cout << (char)((1 == m_cells[rowId][stackId*NROF_STACKS + 0].size()) * GEN_MASK[level][rowId][stackId*NROF_STACKS + 0] ? m_cells[rowId][stackId*NROF_STACKS + 0].front() : 46) << " "
-				      << (char)((1 == m_cells[rowId][stackId*NROF_STACKS + 1].size()) * GEN_MASK[level][rowId][stackId*NROF_STACKS + 1] ? m_cells[rowId][stackId*NROF_STACKS + 1].front() : 46) << " "
-				      << (char)((1 == m_cells[rowId][stackId*NROF_STACKS + 2].size()) * GEN_MASK[level][rowId][stackId*NROF_STACKS + 2] ? m_cells[rowId][stackId*NROF_STACKS + 2].front() : 46) << " "
-				      << "\t";
+		if (0 == (m_logic & ((2 == size) ? LOGIC_XWING : LOGIC_SWORDFISH))) {
+			continue;
+		}
+
+		uint32_t result = fish(size, true);
+
+		if (0 == result) {
+			result = fish(size, false);
+		}
+
+		if (result) {
+			return result;
 		}
-		
-		std::cout << endl;
 	}
 
-	std::cout << endl;
 	return 0;
 }
 
 /**
- * Prints all cell lists. This allows to see all non assigned candidates
+ * Adds the constraints of a variant (see CSudokuConstraints) to the rows, columns and boxes, nullptr for a 
+ * standard Sudoku. The constraints are not copied, they need to outlive the grid. All of them are queued
+ */
+void CSudokuGrid::setConstraints(const CSudokuConstraints *constraints)
+{
+	m_constraints = ((nullptr == constraints) || constraints->empty()) ? nullptr : constraints;
+
+	if (m_constraints) {
+		m_dirty |= m_constraints->getAllGroups();
+	}
+}
+
+const CSudokuConstraints *CSudokuGrid::getConstraints() const
+{
+	return m_constraints;
+}
+
+/**
+ * Solutions looked up by solve() before solving a puzzle, and where the new ones are added (nullptr for
+ * none). The cache is not copied, it needs to outlive the grid
+ */
+void CSudokuGrid::setCache(CSudokuCache *cache)
+{
+	m_cache = cache;
+}
+
+CSudokuCache *CSudokuGrid::getCache() const
+{
+	return m_cache;
+}
+
+/**
+ * Analyses the constraints of a group of the work queue (see CSudokuConstraints)
+ */
+uint32_t CSudokuGrid::checkConstraints(const uint32_t groupId)
+{
+	assert(m_constraints);
+
+	uint32_t result = 0;
+
+	const std::vector<uint32_t> &group = m_constraints->getGroup(groupId);
+
+	for (std::vector<uint32_t>::const_iterator it = group.begin(); (it != group.end()) && (0 == m_conflict); ++it) {
+
+		switch (m_constraints->get(*it).type) {
+
+		case CONSTRAINT_UNIT:
+			result += checkExtraUnit(*it);
+			break;
+
+		case CONSTRAINT_CAGE:
+			result += checkCage(*it);
+			break;
+
+		default:
+			result += checkExclusion(*it);
+			break;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Removes the values assigned within a unit of the variant from the other cells of the unit. A unit of 
+ * 9 cells also looks for hidden singles, see hiddenSingle
+ */
+uint32_t CSudokuGrid::checkExtraUnit(const uint32_t constraintId)
+{
+	const std::vector<uint8_t> &cells = m_constraints->get(constraintId).cells;
+
+	uint32_t result = 0;
+	uint16_t assigned = 0, twice = 0;
+
+	for (uint8_t cellId : cells) {
+
+		const uint16_t cell = m_cells[cellId / NROF_COLS][cellId % NROF_COLS];
+
+		if (1 == bitCount(cell)) {
+
+			twice |= assigned & cell;
+			assigned |= cell;
+		}
+	}
+
+	if (twice) {
+
+		store(m_conflict, 1);
+		return 0;
+	}
+
+	for (uint8_t cellId : cells) {
+
+		const uint16_t cell = m_cells[cellId / NROF_COLS][cellId % NROF_COLS];
+
+		if ((1 < bitCount(cell)) && (cell & assigned)) {
+
+			setCell(cellId / NROF_COLS, cellId % NROF_COLS, cell & ~assigned);
+			result++;
+		}
+	}
+
+	if (NROF_VALUES != cells.size()) {
+		return result;
+	}
+
+	// The cells assigned above are taken into account as well
+	uint16_t cand = 0, candTwice = 0;
+	assigned = 0;
+
+	for (uint8_t cellId : cells) {
+
+		const uint16_t cell = m_cells[cellId / NROF_COLS][cellId % NROF_COLS];
+
+		if (1 < bitCount(cell)) {
+
+			candTwice |= cand & cell;
+			cand |= cell;
+		}
+		else {
+			assigned |= cell;
+		}
+	}
+
+	if (ALL_CANDIDATES & ~(cand | assigned)) {
+
+		store(m_conflict, 1);
+		return result;
+	}
+
+	const uint16_t hidden = cand & ~candTwice & ~assigned;
+
+	for (uint8_t cellId : cells) {
+
+		const uint16_t cell = m_cells[cellId / NROF_COLS][cellId % NROF_COLS];
+		const uint16_t mask = cell & hidden;
+
+		if ((1 < bitCount(cell)) && mask) {
+
+			setCell(cellId / NROF_COLS, cellId % NROF_COLS, (1 == bitCount(mask)) ? mask : 0);
+			result++;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Keeps the candidates of a cage that belong to a set of values of its sum still possible: a set holding
+ * the values assigned within the cage, with a candidate for each of its other cells and a place for each 
+ * of its other values. A value of all those sets with a single place is assigned there
+ */
+uint32_t CSudokuGrid::checkCage(const uint32_t constraintId)
+{
+	const constraint_t &cage = m_constraints->get(constraintId);
+
+	uint32_t result = 0;
+	uint16_t assigned = 0, twice = 0;
+
+	for (uint8_t cellId : cage.cells) {
+
+		const uint16_t cell = m_cells[cellId / NROF_COLS][cellId % NROF_COLS];
+
+		if (1 == bitCount(cell)) {
+
+			twice |= assigned & cell;
+			assigned |= cell;
+		}
+	}
+
+	if (twice) {
+
+		store(m_conflict, 1);
+		return 0;
+	}
+
+	bool possible = false;
+	uint16_t allowed = 0, required = ALL_CANDIDATES;
+
+	for (uint16_t combo : cage.combos) {
+
+		if (assigned != (combo & assigned)) {
+			continue;
+		}
+
+		const uint16_t rest = combo & ~assigned;
+		uint16_t places = 0;
+		bool fits = true;
+
+		for (std::vector<uint8_t>::const_iterator it = cage.cells.begin(); fits && (it != cage.cells.end()); ++it) {
+
+			const uint16_t cell = m_cells[*it / NROF_COLS][*it % NROF_COLS];
+
+			if (1 < bitCount(cell)) {
+
+				fits = (0 != (cell & rest));
+				places |= cell & rest;
+			}
+		}
+
+		if (fits && (places == rest)) {
+
+			possible = true;
+			allowed |= rest;
+			required &= rest;
+		}
+	}
+
+	if (false == possible) {
+
+		store(m_conflict, 1);
+		return 0;
+	}
+
+	for (uint8_t cellId : cage.cells) {
+
+		const uint16_t cell = m_cells[cellId / NROF_COLS][cellId % NROF_COLS];
+
+		if ((1 < bitCount(cell)) && (cell & ~allowed)) {
+
+			setCell(cellId / NROF_COLS, cellId % NROF_COLS, cell & allowed);
+			result++;
+		}
+	}
+
+	// Hidden singles of the values every possible set needs, see hiddenSingle. The cells assigned above 
+	// already hold some of them
+	uint16_t cand = 0, candTwice = 0;
+	assigned = 0;
+
+	for (uint8_t cellId : cage.cells) {
+
+		const uint16_t cell = m_cells[cellId / NROF_COLS][cellId % NROF_COLS];
+
+		if (1 < bitCount(cell)) {
+
+			candTwice |= cand & cell;
+			cand |= cell;
+		}
+		else {
+			assigned |= cell;
+		}
+	}
+
+	const uint16_t hidden = required & cand & ~candTwice & ~assigned;
+
+	for (uint8_t cellId : cage.cells) {
+
+		const uint16_t cell = m_cells[cellId / NROF_COLS][cellId % NROF_COLS];
+		const uint16_t mask = cell & hidden;
+
+		if (hidden && (1 < bitCount(cell)) && mask) {
+
+			setCell(cellId / NROF_COLS, cellId % NROF_COLS, (1 == bitCount(mask)) ? mask : 0);
+			result++;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Removes the value of an assigned cell from the cells it excludes
+ */
+uint32_t CSudokuGrid::checkExclusion(const uint32_t constraintId)
+{
+	const std::vector<uint8_t> &cells = m_constraints->get(constraintId).cells;
+
+	const uint16_t value = m_cells[cells.front() / NROF_COLS][cells.front() % NROF_COLS];
+
+	if (1 != bitCount(value)) {
+		return 0;
+	}
+
+	uint32_t result = 0;
+
+	for (std::vector<uint8_t>::const_iterator it = cells.begin() + 1; it != cells.end(); ++it) {
+
+		const uint16_t cell = m_cells[*it / NROF_COLS][*it % NROF_COLS];
+
+		if (cell & value) {
+
+			// Left without candidates when it already holds the value, which is a conflict
+			setCell(*it / NROF_COLS, *it % NROF_COLS, cell & ~value);
+			result++;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Performs all previous analysis (basic) techniques in other to remove candidates from the cells iterativelly
+ * and checks for the validity of the grid.
+ *
+ * Only the units in the work queue are analysed, that is, the rows, columns and boxes with cells that lost 
+ * candidates since the last check. Every analysed unit counts as an iteration. When the queue is empty, the 
+ * advanced techniques enabled with setLogic are tried.
+ */
+int CSudokuGrid::checkGrid(uint32_t &iter, const bool show)
+{
+	int retVal = VALID_NOT_SOLVED;
+
+	do {
+
+		while (m_dirty && (0 == m_conflict)) {
+
+			const uint32_t unitId = bitIndex64(m_dirty);
+			m_dirty &= m_dirty - 1;
+
+			checkUnit(unitId);
+			iter++;
+		}
+
+		// The advanced techniques only run once the basic ones are exhausted, any progress refills the queue
+	} while (m_logic && (0 == m_conflict) && (false == isSolved()) && checkLogic());
+
+	if (m_conflict) {
+
+		// Nothing left to analyse once the grid is known to be invalid
+		m_dirty = 0;
+		return NOT_VALID;
+	}
+
+	const bool solved = isSolved();
+
+	if (solved) {
+
+		retVal = VALID_SOLVED;
+
+		if (show) {
+
+			std::cout << "Puzzle solved!";
+			print();
+		}
+	}
+
+	return retVal;
+}
+
+/**
+ * Applies the analysis (basic) techniques to a single unit: all units remove the values already assigned 
+ * and look for hidden singles, boxes also look for intersections with their rows and columns
+ */
+uint32_t CSudokuGrid::checkUnit(const uint32_t unitId)
+{
+	assert(unitId < (NROF_UNITS + NROF_CONSTRAINT_GROUPS));
+
+	if (unitId >= NROF_UNITS) {
+		return checkConstraints(unitId - NROF_UNITS);
+	}
+
+	if (unitId < NROF_ROWS) {
+		return checkRow((uint16_t)unitId) + hiddenSingle(unitId);
+	}
+
+	if (unitId < (NROF_ROWS + NROF_COLS)) {
+		return checkColumn((uint16_t)(unitId - NROF_ROWS)) + hiddenSingle(unitId);
+	}
+
+	const uint16_t bandId = (uint16_t)((unitId - NROF_ROWS - NROF_COLS) / NROF_STACKS);
+	const uint16_t stackId = (uint16_t)((unitId - NROF_ROWS - NROF_COLS) % NROF_STACKS);
+
+	uint32_t result = 0;
+
+	result += checkBox(bandId, stackId);
+	result += hiddenSingle(unitId);
+	result += pointRow(bandId, stackId);
+	result += pointCol(bandId, stackId);
+
+	return result;
+}
+
+/**
+ * Solves the Sudoku grid first by trying to use the analysis (basic) techniques. In case these do not solve the grid,
+ * all possible combinations are checked in a brute force approach that finally gives the solution to the grid
+ */
+int CSudokuGrid::solve(uint32_t &iter, const bool show)
+{
+	searchStats_t stats;
+
+	const int retVal = solve(stats, show);
+	iter = stats.iter;
+
+	return retVal;
+}
+
+/**
+ * Same as above, also providing the statistics of the brute force search. The brute force part is done 
+ * either by the backtracking search, sequential or over 'nrofThreads' threads, or by the Dancing Links 
+ * exact cover solver ('engine'). With a cache (see setCache), a puzzle equivalent to one solved before
+ * takes its solution from the cache instead
+ */
+int CSudokuGrid::solve(searchStats_t &stats, const bool show, const int engine, const uint32_t nrofThreads)
+{
+	// The transformations do not keep the constraints of a variant
+	if ((nullptr == m_cache) || m_constraints || m_conflict) {
+		return solveGrid(stats, show, engine, nrofThreads);
+	}
+
+	char puzzle[NROF_ROWS * NROF_COLS];
+	char canonical[NROF_ROWS * NROF_COLS];
+	transform_t transform;
+
+	writeLine(puzzle);
+
+	if (findCached(*m_cache, puzzle, canonical, transform)) {
+
+		stats = searchStats_t();
+		readLine(puzzle, NROF_ROWS * NROF_COLS);
+
+		if (show) {
+
+			std::cout << "Puzzle solved!";
+			print();
+		}
+
+		return VALID_SOLVED;
+	}
+
+	const int retVal = solveGrid(stats, show, engine, nrofThreads);
+
+	// Puzzles without canonical form are not cached
+	if ((VALID_SOLVED == retVal) && canonical[0]) {
+
+		char solution[NROF_ROWS * NROF_COLS];
+		char canonicalSolution[NROF_ROWS * NROF_COLS];
+
+		writeLine(solution);
+		CSudokuCanonical::apply(transform, solution, canonicalSolution);
+
+		m_cache->insert(canonical, canonicalSolution);
+	}
+
+	return retVal;
+}
+
+/**
+ * Solves the grid with the analysis techniques first and then the brute force 'engine'
+ */
+int CSudokuGrid::solveGrid(searchStats_t &stats, const bool show, const int engine, const uint32_t nrofThreads)
+{
+	stats = searchStats_t();
+
+	int retVal = checkGrid(stats.iter, show);
+
+	if (VALID_NOT_SOLVED != retVal) {
+		return retVal;
+	}
+
+	// The exact cover of Dancing Links only holds the rows, columns and boxes
+	if ((ENGINE_DLX == engine) && (nullptr == m_constraints)) {
+
+		CSudokuDLX dlx;
+
+		retVal = dlx.solve(*this, stats);
+
+		if ((VALID_SOLVED == retVal) && show) {
+
+			std::cout << "Puzzle solved!";
+			print();
+		}
+	}
+	else if (1 < nrofThreads) {
+		retVal = searchParallel(stats, nrofThreads, show);
+	}
+	else {
+		retVal = search(stats, show);
+	}
+
+	return retVal;
+}
+
+/**
+ * Verifies if the Sudoku grid is solved
+ */
+bool CSudokuGrid::isSolved()
+{
+	// Every row, column and box holds all the values exactly once
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		if (ALL_CANDIDATES != m_rowMask[rowId]) {
+			return false;
+		}
+	}
+
+	for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+
+		if (ALL_CANDIDATES != m_colMask[colId]) {
+			return false;
+		}
+	}
+
+	for (uint16_t bandId = 0; bandId < NROF_BANDS; bandId++) {
+
+		for (uint16_t stackId = 0; stackId < NROF_STACKS; stackId++) {
+
+			if (ALL_CANDIDATES != m_boxMask[bandId][stackId]) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * True when a cell ran out of candidates or a value was assigned twice within a unit
+ */
+bool CSudokuGrid::hasConflict() const
+{
+	return (0 != m_conflict);
+}
+
+/**
+ * Prints the Sudoku grid layout in boxes
+ */
+int CSudokuGrid::print(const uint8_t level)
+{
+	assert(level <= NROF_LEVELS);
+
+	std::cout << endl;
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		if (0 == (rowId % 3)) {
+			std::cout << endl;
+		}
+
+		for (uint16_t stackId = 0; stackId < NROF_STACKS; stackId++) {
+
+			for (uint16_t colId = stackId * NROF_STACKS; colId < (stackId + 1) * NROF_STACKS; colId++) {
+
+				const uint16_t cell = m_cells[rowId][colId];
+				std::cout << (char)(((1 == bitCount(cell)) && GEN_MASK[level][rowId][colId]) ? bitToVal(cell) : 46) << " ";
+			}
+
+			std::cout << "\t";
+		}
+		
+		std::cout << endl;
+	}
+
+	std::cout << endl;
+	return 0;
+}
+
+/**
+ * Prints all cell lists. This allows to see all non assigned candidates
+ */
+void CSudokuGrid::dump()
+{
+	std::cout << endl;
+
+	for (uint16_t bandId = 0; bandId < (NROF_ROWS / NROF_BANDS); bandId++) {
+
+		for (uint16_t stackId = 0; stackId < (NROF_COLS / NROF_STACKS); stackId++) {
+			dumpBox(bandId, stackId);
+
+			std::cout << endl;
+		}
+	}
+}
+
+/**
+ * Prints cell's list
+ */
+void CSudokuGrid::dumpCell(const uint16_t rowId, const uint16_t colId) 
+{
+	assert(rowId < NROF_ROWS);
+	assert(colId < NROF_COLS);
+
+	std::cout << "[" << rowId << "]" << "[" << colId << "] : ";
+
+	for (uint16_t mask = m_cells[rowId][colId]; mask; mask &= (mask - 1))
+		std::cout << ' ' << bitToVal(mask);
+
+	std::cout << endl;
+}
+
+/**
+ * Prints all cells lists within a row
+ */
+void CSudokuGrid::dumpRow(const uint16_t rowId)
+{
+	assert(rowId < NROF_ROWS);
+
+	for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+		dumpCell(rowId, colId);
+	}
+}
+
+/**
+ * Prints all cells lists within a column
+ */
+void CSudokuGrid::dumpCol(const uint16_t colId)
+{
+	assert(colId < NROF_ROWS);
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+		dumpCell(rowId, colId);
+	}
+}
+
+/**
+ * Prints all cells lists within a box
+ */
+void CSudokuGrid::dumpBox(const uint16_t bandId, const uint16_t stackId)
+{
+	assert(bandId < NROF_BANDS);
+	assert(stackId < NROF_STACKS);
+
+	for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
+
+		for (uint16_t colId = 0; colId < (NROF_COLS / NROF_STACKS); colId++) {
+
+			const uint16_t _rowId = bandId * (NROF_ROWS / NROF_BANDS) + rowId;
+			const uint16_t _colId = stackId * (NROF_COLS / NROF_STACKS) + colId;
+			
+			dumpCell(_rowId, _colId);
+		}
+	}
+}
+
+/**
+ * Generate a Sudoku puzzle according to a level of difficulty
+ */
+int CSudokuGrid::generate(const uint8_t level, const bool show)
+{
+    // obtain a time-based seed
+	std::mt19937 random((uint32_t)std::chrono::system_clock::now().time_since_epoch().count());
+
+	return generate(level, random, show);
+}
+
+/**
+ * Same as above, generating puzzle 'number' of the sequence of puzzles of 'seed'. The same seed, number and 
+ * level always give the same puzzle, so a sequence can be split in ranges generated independently
+ */
+int CSudokuGrid::generate(const uint8_t level, const uint64_t seed, const uint64_t number, const bool show)
+{
+	std::mt19937 random;
+	seedRandom(random, seed, number);
+
+	return generate(level, random, show);
+}
+
+/**
+ * Pattern-free generation: builds a random full grid and removes its clues in random order, keeping 
+ * the ones whose removal leaves more than one solution, until only 'nrofClues' are left or none can be 
+ * removed. With MASK_SYMMETRIC clues are removed in pairs symmetric about the centre of the grid. 
+ * The grid is left with the clues of the puzzle only. Returns the number of clues
+ */
+uint32_t CSudokuGrid::generateClues(const uint32_t nrofClues, const uint8_t mask, std::mt19937 &random)
+{
+	assert(MASK_LEVEL != mask);
+
+	if (false == fillGrid(random)) {
+		return 0;
+	}
+
+	char puzzle[NROF_ROWS * NROF_COLS];
+	writeLine(puzzle);
+
+	// Symmetric pairs are taken through their first cell, the centre is its own pair
+	const uint16_t nrofCells = NROF_ROWS * NROF_COLS;
+	std::vector<uint16_t> cells((MASK_SYMMETRIC == mask) ? (nrofCells + 1) / 2 : nrofCells);
+
+	for (uint16_t cellId = 0; cellId < cells.size(); cellId++) {
+		cells[cellId] = cellId;
+	}
+
+	shuffle(cells, random);
+
+	uint32_t clues = nrofCells;
+
+	for (std::vector<uint16_t>::iterator it = cells.begin(); (it != cells.end()) && (clues > nrofClues); ++it) {
+
+		const uint16_t cellId = *it;
+		const uint16_t pairId = (MASK_SYMMETRIC == mask) ? (nrofCells - 1 - cellId) : cellId;
+
+		const char value = puzzle[cellId];
+		const char pairValue = puzzle[pairId];
+
+		puzzle[cellId] = 46; // '.' = 46
+		puzzle[pairId] = 46;
+
+		readLine(puzzle, nrofCells);
+
+		if (1 == countSolutions(2)) {
+			clues -= (cellId == pairId) ? 1 : 2;
+		}
+		else {
+
+			puzzle[cellId] = value;
+			puzzle[pairId] = pairValue;
+		}
+	}
+
+	readLine(puzzle, nrofCells);
+
+	return clues;
+}
+
+/**
+ * Fills the whole grid with a random solution, searching from the empty grid with the candidates of 
+ * every cell tried in random order
+ */
+bool CSudokuGrid::fillGrid(std::mt19937 &random)
+{
+	assert(nullptr == m_trail);
+
+	initGrid();
+
+	trailEntry_t trail[TRAIL_SIZE];
+
+	m_trail = trail;
+	m_trailTop = 0;
+	m_random = &random;
+
+	uint32_t iter = 0;
+	int retVal = checkGrid(iter, false);
+
+	if (VALID_NOT_SOLVED == retVal) {
+		retVal = fillTrail();
+	}
+
+	m_trail = nullptr;
+	m_trailTop = 0;
+	m_random = nullptr;
+
+	return (VALID_SOLVED == retVal);
+}
+
+/**
+ * Seeds 'random' for puzzle 'number' of the sequence of puzzles of 'seed'
+ */
+void CSudokuGrid::seedRandom(std::mt19937 &random, const uint64_t seed, const uint64_t number)
+{
+	std::seed_seq sequence{ (uint32_t)seed, (uint32_t)(seed >> 32), (uint32_t)number, (uint32_t)(number >> 32) };
+	random.seed(sequence);
+}
+
+/**
+ * Same as above, drawing all the random choices from 'random'
+ */
+int CSudokuGrid::generate(const uint8_t level, std::mt19937 &random, const bool show)
+{
+	assert(level < NROF_LEVELS);
+
+	initGrid();
+
+	// Shuffle do not apply on lists
+	std::vector<char> val{ from1to9.begin(), from1to9.end() };
+	shuffle(val, random);
+
+	m_random = &random;
+
+	int retVal;
+	int iter = 0;
+
+	// Every attempt is undone through the trail before trying again
+	trailEntry_t trail[TRAIL_SIZE];
+
+	m_trail = trail;
+	m_trailTop = 0;
+
+	const uint64_t dirty = m_dirty;
+
+	do {
+
+		retVal = chance(val, level);
+		iter++;
+
+		if (show) {
+			std::cout << "\rIter: " << iter;
+		}
+
+		if (NOT_VALID == retVal) {
+
+			undo(0);
+			m_dirty = dirty;
+		}
+
+	} while (NOT_VALID == retVal);
+
+	m_trail = nullptr;
+	m_trailTop = 0;
+	m_random = nullptr;
+
+	if ((VALID_SOLVED == retVal) && show) {
+
+		std::cout << "\nPuzzle generated! " << std::endl;
+		print(level);
+	}
+
+	return iter;
+}
+
+/**
+ * Locates the box with less combined candidates ('best box') and the cell within the box with less candidates ('best cell'). 
+ * Then, it will assign the first candidate for the 'best cell' as its value and will try to solve the grid by appliying 
+ * the basic techniques. In case it is not solved but it is still a valid grid, it will continue recursively the procedure till
+ * the grid is solved or invalid.
+ *
+ * Instead of copying the grid for every candidate, the changes are recorded in a trail and undone when the 
+ * candidate does not lead to a solution. When solved, the grid holds the solution.
+ */
+int CSudokuGrid::search(uint32_t &iter, const bool show)
+{
+	searchStats_t stats = searchStats_t();
+	stats.iter = iter;
+
+	const int retVal = search(stats, show);
+	iter = stats.iter;
+
+	return retVal;
+}
+
+/**
+ * Same as above, accumulating the statistics of the search in 'stats'
+ */
+int CSudokuGrid::search(searchStats_t &stats, const bool show)
+{
+	// Nested searches (e.g. while generating) share the trail already in use
+	if (m_trail) {
+		return searchTrail(stats, 1, show);
+	}
+
+	trailEntry_t trail[TRAIL_SIZE];
+
+	m_trail = trail;
+	m_trailTop = 0;
+
+	const int retVal = searchTrail(stats, 1, show);
+
+	m_trail = nullptr;
+	m_trailTop = 0;
+
+	return retVal;
+}
+
+/**
+ * Recursive step of the search. Every candidate of the 'best cell' is tried in turn, undoing 
+ * through the trail the changes of the candidates that do not solve the grid
+ */
+int CSudokuGrid::searchTrail(searchStats_t &stats, const uint32_t depth, const bool show)
+{
+	size_t size;
+	uint16_t bandId, stackId;
+	uint16_t rowId, colId;
+
+	int retVal = VALID_NOT_SOLVED;
+
+	// Another thread already found the solution
+	if (m_cancel && m_cancel->load(std::memory_order_relaxed)) {
+		return VALID_NOT_SOLVED;
+	}
+
+	if (NOT_VALID == searchBox(bandId, stackId, size)) {
+		return NOT_VALID;
+	}
+
+	if (NOT_VALID == searchCell(bandId, stackId, rowId, colId, size)) {
+		return NOT_VALID;
+	}
+
+	stats.maxDepth = std::max(stats.maxDepth, depth);
+
+	const uint32_t trailMark = m_trailTop;
+	const uint64_t dirty = m_dirty;
+	const uint16_t cellCpy = m_cells[rowId][colId];
+
+	for (uint16_t mask = cellCpy; mask; mask &= (mask - 1)) {
+
+		stats.branches++;
+		assign(rowId, colId, bitToVal(mask));
+
+		retVal = checkGrid(stats.iter, show);
+
+		stats.maxTrailDepth = std::max(stats.maxTrailDepth, m_trailTop);
+
+		if (VALID_SOLVED == retVal) {
+			return retVal;
+		}
+
+		if (VALID_NOT_SOLVED == retVal) {
+
+			retVal = searchTrail(stats, depth + 1, show);
+
+			if (VALID_SOLVED == retVal) {
+				return retVal;
+			}
+		}
+
+		undo(trailMark);
+		m_dirty = dirty;
+		stats.backtracks++;
+	}
+	
+	return retVal;
+}
+
+/**
+ * Counts the solutions of the grid, stopping as soon as 'limit' of them are found (0 for no limit), 
+ * so a limit of 2 tells whether the solution is unique. The grid is left as it was
  */
-void CSudokuGrid::dump()
+uint32_t CSudokuGrid::countSolutions(const uint32_t limit)
 {
-	std::cout << endl;
+	// Nested counts (e.g. while generating) share the trail already in use
+	trailEntry_t trail[TRAIL_SIZE];
+	const bool ownTrail = (nullptr == m_trail);
 
-	for (uint16_t bandId = 0; bandId < (NROF_ROWS / NROF_BANDS); bandId++) {
+	if (ownTrail) {
 
-		for (uint16_t stackId = 0; stackId < (NROF_COLS / NROF_STACKS); stackId++) {
-			dumpBox(bandId, stackId);
+		m_trail = trail;
+		m_trailTop = 0;
+	}
 
-			std::cout << endl;
-		}
+	const uint32_t trailMark = m_trailTop;
+	const uint64_t dirty = m_dirty;
+
+	uint32_t count = 0;
+	uint32_t iter = 0;
+
+	const int retVal = checkGrid(iter, false);
+
+	if (VALID_SOLVED == retVal) {
+		count = 1;
+	}
+	else if (VALID_NOT_SOLVED == retVal) {
+		countTrail(count, (0 == limit) ? UINT32_MAX : limit);
 	}
-}
 
-/**
- * Prints cell's list
- */
-void CSudokuGrid::dumpCell(const uint16_t rowId, const uint16_t colId) 
-{
-	assert(rowId < NROF_ROWS);
-	assert(colId < NROF_COLS);
+	undo(trailMark);
+	m_dirty = dirty;
 
-	std::cout << "[" << rowId << "]" << "[" << colId << "] : ";
+	if (ownTrail) {
 
-	for (std::list<char>::iterator it = m_cells[rowId][colId].begin(); it != m_cells[rowId][colId].end(); ++it)
-		std::cout << ' ' << *it;
+		m_trail = nullptr;
+		m_trailTop = 0;
+	}
 
-	std::cout << endl;
+	return count;
 }
 
 /**
- * Prints all cells lists within a row
+ * Recursive step of the count. Same as searchTrail, but every candidate of the 'best cell' is undone 
+ * after being tried, until the limit is reached
  */
-void CSudokuGrid::dumpRow(const uint16_t rowId)
+void CSudokuGrid::countTrail(uint32_t &count, const uint32_t limit)
 {
-	assert(rowId < NROF_ROWS);
+	size_t size;
+	uint16_t bandId, stackId;
+	uint16_t rowId, colId;
 
-	for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
-		dumpCell(rowId, colId);
+	if (NOT_VALID == searchBox(bandId, stackId, size)) {
+		return;
 	}
-}
 
-/**
- * Prints all cells lists within a column
- */
-void CSudokuGrid::dumpCol(const uint16_t colId)
-{
-	assert(colId < NROF_ROWS);
+	if (NOT_VALID == searchCell(bandId, stackId, rowId, colId, size)) {
+		return;
+	}
 
-	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
-		dumpCell(rowId, colId);
+	const uint32_t trailMark = m_trailTop;
+	const uint64_t dirty = m_dirty;
+	const uint16_t cellCpy = m_cells[rowId][colId];
+
+	uint32_t iter = 0;
+
+	for (uint16_t mask = cellCpy; mask && (count < limit); mask &= (mask - 1)) {
+
+		assign(rowId, colId, bitToVal(mask));
+
+		const int retVal = checkGrid(iter, false);
+
+		if (VALID_SOLVED == retVal) {
+			count++;
+		}
+		else if (VALID_NOT_SOLVED == retVal) {
+			countTrail(count, limit);
+		}
+
+		undo(trailMark);
+		m_dirty = dirty;
 	}
 }
 
 /**
- * Prints all cells lists within a box
+ * Parallel version of the search for a single puzzle. The first levels of the search tree are expanded 
+ * into independent grids, which are searched as tasks by a pool of 'nrofThreads' threads (kept for the
+ * next searches of the calling thread, see searchPool). As soon as one of them is solved, the other tasks
+ * are cancelled at their next branch.
  */
-void CSudokuGrid::dumpBox(const uint16_t bandId, const uint16_t stackId)
+int CSudokuGrid::searchParallel(searchStats_t &stats, const uint32_t nrofThreads, const bool show)
 {
-	assert(bandId < NROF_BANDS);
-	assert(stackId < NROF_STACKS);
+	std::vector<CSudokuGrid> tasks(1, *this);
+	uint32_t depth;
 
-	for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
+	for (depth = 0; (depth < PARALLEL_MAX_DEPTH) && (tasks.size() < PARALLEL_TASKS_PER_THREAD * nrofThreads); depth++) {
 
-		for (uint16_t colId = 0; colId < (NROF_COLS / NROF_STACKS); colId++) {
+		std::vector<CSudokuGrid> children;
 
-			const uint16_t _rowId = bandId * (NROF_ROWS / NROF_BANDS) + rowId;
-			const uint16_t _colId = stackId * (NROF_COLS / NROF_STACKS) + colId;
-			
-			dumpCell(_rowId, _colId);
+		for (std::vector<CSudokuGrid>::iterator it = tasks.begin(); it != tasks.end(); ++it) {
+
+			if (VALID_SOLVED == it->branch(children, stats, depth + 1)) {
+
+				*this = children.back();
+
+				if (show) {
+
+					std::cout << "Puzzle solved!";
+					print();
+				}
+
+				return VALID_SOLVED;
+			}
+		}
+
+		tasks.swap(children);
+
+		if (tasks.empty()) {
+			return NOT_VALID;
 		}
 	}
-}
 
-/**
- * Generate a Sudoku puzzle according to a level of difficulty
- */
-int CSudokuGrid::generate(const uint8_t level)
-{
-	assert(level < NROF_LEVELS);
+	int retVal = NOT_VALID;
 
-	initGrid();
+	std::atomic<bool> cancel(false);
+	std::mutex lock;
 
-	// Shuffle do not apply on lists
-	std::vector<char> val{ from1to9.begin(), from1to9.end() };
+	CSudokuPool &pool = searchPool(nrofThreads);
 
-    // obtain a time-based seed
-	uint32_t seed = (uint32_t)std::chrono::system_clock::now().time_since_epoch().count();
-	std::shuffle(val.begin(), val.end(), std::default_random_engine(seed));
+	pool.run((uint32_t)tasks.size(), [&](const uint32_t, const uint32_t taskId) {
 
-	int retVal;
-	int iter = 0;
+		if (cancel.load(std::memory_order_relaxed)) {
+			return;
+		}
 
-	do {
+		CSudokuGrid &grid = tasks[taskId];
+		searchStats_t taskStats = searchStats_t();
 
-		retVal = chance(val, level);
-		std::cout << "\rIter: " << ++iter;
+		grid.m_cancel = &cancel;
+		const int result = grid.search(taskStats, false);
+		grid.m_cancel = nullptr;
 
-	} while (NOT_VALID == retVal);
+		std::lock_guard<std::mutex> guard(lock);
 
-	if (VALID_SOLVED == retVal) {
+		stats.iter += taskStats.iter;
+		stats.branches += taskStats.branches;
+		stats.backtracks += taskStats.backtracks;
+		stats.maxDepth = std::max(stats.maxDepth, depth + taskStats.maxDepth);
+		stats.maxTrailDepth = std::max(stats.maxTrailDepth, taskStats.maxTrailDepth);
 
-		std::cout << "\nPuzzle generated! " << std::endl;
-		print(level);
+		if ((VALID_SOLVED == result) && (false == cancel.load())) {
+
+			cancel.store(true);
+
+			*this = grid;
+			retVal = VALID_SOLVED;
+		}
+	});
+
+	if ((VALID_SOLVED == retVal) && show) {
+
+		std::cout << "Puzzle solved!";
+		print();
 	}
 
-	return iter;
+	return retVal;
 }
 
 /**
- * Locates the box with less combined candidates ('best box') and the cell within the box with less candidates ('best cell'). 
- * Then, it will assign the first candidate for the 'best cell' as its value and will try to solve the grid by appliying 
- * the basic techniques. In case it is not solved but it is still a valid grid, it will continue recursively the procedure till
- * the grid is solved or invalid.
+ * Expands one level of the search tree: for every candidate of the 'best cell', a copy of the grid with the 
+ * candidate assigned and the basic techniques applied is added to 'children', unless it is not valid. 
+ * When one of them is solved, it is the last child and VALID_SOLVED is returned. 'depth' is the depth of the
+ * 'best cell' in the search tree, as counted by searchTrail
  */
-int CSudokuGrid::search(uint32_t &iter, const bool show)
+int CSudokuGrid::branch(std::vector<CSudokuGrid> &children, searchStats_t &stats, const uint32_t depth)
 {
 	size_t size;
 	uint16_t bandId, stackId;
 	uint16_t rowId, colId;
 
-	int retVal = VALID_NOT_SOLVED;
-
 	if (NOT_VALID == searchBox(bandId, stackId, size)) {
 		return NOT_VALID;
 	}
@@ -713,33 +2174,31 @@ int CSudokuGrid::search(uint32_t &iter, const bool show)
 		return NOT_VALID;
 	}
 
-	std::list<char> cellCpy = getCell(rowId, colId);
-	CSudokuGrid gridCpy;
+	stats.maxDepth = std::max(stats.maxDepth, depth);
 
-	std::list<char>::iterator it;
-	for (it = cellCpy.begin(); it != cellCpy.end(); ++it) {
+	for (uint16_t mask = m_cells[rowId][colId]; mask; mask &= (mask - 1)) {
 
-		gridCpy = *this;
-		gridCpy.assign(rowId, colId, *it);
+		stats.branches++;
 
-		retVal = gridCpy.checkGrid(iter, show);
+		CSudokuGrid child(*this);
+		child.assign(rowId, colId, bitToVal(mask));
 
-		if (VALID_SOLVED == retVal) {
-			return retVal;
-		}
+		const int retVal = child.checkGrid(stats.iter, false);
 
-		if (VALID_NOT_SOLVED == retVal) {
+		if (NOT_VALID == retVal) {
 
-			//gridCpy.print();
-			retVal = gridCpy.search(iter, show);
+			stats.backtracks++;
+			continue;
+		}
 
-			if (VALID_SOLVED == retVal) {
-				return retVal;
-			}
+		children.push_back(child);
+
+		if (VALID_SOLVED == retVal) {
+			return retVal;
 		}
 	}
-	
-	return retVal;
+
+	return VALID_NOT_SOLVED;
 }
 
 /**
@@ -747,20 +2206,47 @@ int CSudokuGrid::search(uint32_t &iter, const bool show)
  */
 std::list<char> CSudokuGrid::getCell(const uint16_t rowId, const uint16_t colId) const
 {
+	assert(rowId < NROF_ROWS);
+	assert(colId < NROF_COLS);
+
+	std::list<char> cell;
+
+	for (uint16_t mask = m_cells[rowId][colId]; mask; mask &= (mask - 1))
+		cell.push_back(bitToVal(mask));
+
+	return cell;
+}
+
+/**
+ * Return the candidates for a given cell as a mask of values
+ */
+uint16_t CSudokuGrid::getCandidates(const uint16_t rowId, const uint16_t colId) const
+{
+	assert(rowId < NROF_ROWS);
+	assert(colId < NROF_COLS);
+
 	return m_cells[rowId][colId];
 }
 
 /**
  * Overloading of '=' operator for the CSudokuGrid class 
  */
-CSudokuGrid CSudokuGrid::operator=(const CSudokuGrid & grid)
+CSudokuGrid &CSudokuGrid::operator=(const CSudokuGrid & grid)
 {
-	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+	// The trail refers to the words of the grid it was recorded on, it is never copied
+	assert(nullptr == m_trail);
+
+	std::memcpy(m_cells, grid.m_cells, sizeof(m_cells));
+	std::memcpy(m_rowMask, grid.m_rowMask, sizeof(m_rowMask));
+	std::memcpy(m_colMask, grid.m_colMask, sizeof(m_colMask));
+	std::memcpy(m_boxMask, grid.m_boxMask, sizeof(m_boxMask));
+
+	m_conflict = grid.m_conflict;
+	m_dirty = grid.m_dirty;
+	m_logic = grid.m_logic;
+	m_constraints = grid.m_constraints;
+	m_cache = grid.m_cache;
 
-		for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
-			m_cells[rowId][colId] = grid.getCell(rowId, colId);
-		}
-	}
 	return *this;
 }
 
@@ -771,28 +2257,25 @@ bool CSudokuGrid::IsRowValid(const uint16_t rowId)
 {
 	assert(rowId < NROF_ROWS);
 
-	bool result = true;
-	std::list<char> val;
+	uint16_t val = 0;
 
 	for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
 
-		if(1 == m_cells[rowId][colId].size()){
-			val.push_back(m_cells[rowId][colId].front());
-		}
-	}
+		const uint16_t cell = m_cells[rowId][colId];
 
-	val.sort();
-	for (std::list<char>::iterator it = val.begin(); it != val.end(); ++it) {
+		// No candidates left or value already assigned in the row
+		if ((0 == cell) || ((1 == bitCount(cell)) && (val & cell))) {
 
-		int count = (int)std::count(it, val.end(), *it);
-		if (1 < count) {
+			//std::cout << "Wrong Row(" << rowId << ") " << bitToVal(cell) << endl;
+			return false;
+		}
 
-			//std::cout << "Wrong Row(" << rowId << ") " << *it << " appears " << count << " times" << endl;
-			result = false;
+		if (1 == bitCount(cell)) {
+			val |= cell;
 		}
 	}
 
-	return result;
+	return true;
 }
 
 /**
@@ -802,28 +2285,25 @@ bool CSudokuGrid::IsColValid(const uint16_t colId)
 {
 	assert(colId < NROF_COLS);
 
-	bool result = true;
-	std::list<char> val;
+	uint16_t val = 0;
 
-	for (uint16_t rowId = 0; rowId < NROF_COLS; rowId++) {
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
 
-		if (1 == m_cells[rowId][colId].size()) {
-			val.push_back(m_cells[rowId][colId].front());
-		}
-	}
+		const uint16_t cell = m_cells[rowId][colId];
 
-	val.sort();
-	for (std::list<char>::iterator it = val.begin(); it != val.end(); ++it) {
+		// No candidates left or value already assigned in the column
+		if ((0 == cell) || ((1 == bitCount(cell)) && (val & cell))) {
 
-		int count = (int)std::count(it, val.end(), *it);
-		if (1 < count) {
+			//std::cout << "Wrong Col(" << colId << ") " << bitToVal(cell) << endl;
+			return false;
+		}
 
-			//std::cout << "Wrong Col(" << colId << ") " << *it << " appears " << count << " times" << endl;
-			result = false;
+		if (1 == bitCount(cell)) {
+			val |= cell;
 		}
 	}
 
-	return result;
+	return true;
 }
 
 /**
@@ -834,32 +2314,29 @@ bool CSudokuGrid::IsBoxValid(const uint16_t bandId, const uint16_t stackId)
 	assert(bandId < NROF_BANDS);
 	assert(stackId < NROF_STACKS);
 
-	bool result = true;
-	std::list<char> val;
+	uint16_t val = 0;
 
 	for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
 
 		for (uint16_t colId = 0; colId < (NROF_COLS / NROF_STACKS); colId++) {
 
 			const cellPos_t cellPos{ (uint16_t)(bandId * (NROF_ROWS / NROF_BANDS) + rowId), (uint16_t)(stackId * (NROF_COLS / NROF_STACKS) + colId) };
+			const uint16_t cell = m_cells[cellPos.rowId][cellPos.colId];
 
-			if (1 == m_cells[cellPos.rowId][cellPos.colId].size())
-				val.push_back(m_cells[cellPos.rowId][cellPos.colId].front());
-		}
-	}
+			// No candidates left or value already assigned in the box
+			if ((0 == cell) || ((1 == bitCount(cell)) && (val & cell))) {
 
-	val.sort();
-	for (std::list<char>::iterator it = val.begin(); it != val.end(); ++it) {
-
-		int count = (int)std::count(it, val.end(), *it);
-		if (1 < count) {
+				//std::cout << "Wrong Box(" << bandId << ", " << stackId << ") " << bitToVal(cell) << endl;
+				return false;
+			}
 
-			//std::cout << "Wrong Box(" << bandId << ", " << stackId << ") " << *it << " appears " << count << " times" << endl;
-			result = false;
+			if (1 == bitCount(cell)) {
+				val |= cell;
+			}
 		}
 	}
 
-	return result;
+	return true;
 }
 
 /**
@@ -867,74 +2344,20 @@ bool CSudokuGrid::IsBoxValid(const uint16_t bandId, const uint16_t stackId)
  */
 bool CSudokuGrid::IsGridValid()
 {
-	bool result = true;
-
-	for(uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
-		
-		if (false == IsRowValid(rowId)) {
-			result = false;
-		}
-	}
-
-	for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
-
-		if (false == IsColValid(colId)) {
-			result = false;
-		}
-	}
-
-	for (uint16_t bandId = 0; bandId < NROF_BANDS; bandId++) {
-
-		for (uint16_t stackId = 0; stackId < NROF_STACKS; stackId++) {
-
-			if(false == IsBoxValid(bandId, stackId)) {
-				result = false;
-			}
-		}
-	}
-
-	return result;
-}
-
-/**
- * Removes all candidates provided in argument 'val' which coordinates are provided in 'candPos' from the grid
- */
-uint32_t CSudokuGrid::remove(std::vector<char> &val, std::vector<cellPos_t> &candPos)
-{
-	uint32_t result = 0;
-
-	for (std::vector<cellPos_t>::iterator itId = candPos.begin(); itId != candPos.end(); ++itId) {
-
-		const uint16_t rowId = (*itId).rowId;
-		const uint16_t colId = (*itId).colId;
-
-		for (std::vector<char>::iterator it = val.begin(); it != val.end(); ++it) {
+	unitScan_t scan;
+	scanUnits(m_cells, scan);
 
-			if (1 < m_cells[rowId][colId].size()) {
-
-				m_cells[rowId][colId].remove(*it);
-
-				if (1 == m_cells[rowId][colId].size()) {
-					result++;
-				}
-				else {
-					m_cells[rowId][colId].sort();
-				}
-			}
-		}
-	}
-
-	return result;
+	return scan.valid && ((nullptr == m_constraints) || m_constraints->isValid(m_cells));
 }
 
 /**
- * Removes all candidates equal to 'val' from a given row 
+ * Removes all candidates within 'mask' from a given row, except for the cells of the given stack
  */
-uint32_t CSudokuGrid::removeInRow(const uint16_t rowId, const uint16_t stackId, const char val)
+uint32_t CSudokuGrid::removeInRow(const uint16_t rowId, const uint16_t stackId, const uint16_t mask)
 {
 	assert(rowId < NROF_ROWS);
 	assert(stackId < NROF_STACKS);
-	assert(val >= 49); assert(val <= 57); // '1' = 49, '9' = 57
+	assert(0 == (mask & ~ALL_CANDIDATES));
 
 	uint32_t result = 0;
 
@@ -942,14 +2365,12 @@ uint32_t CSudokuGrid::removeInRow(const uint16_t rowId, const uint16_t stackId,
 
 		if ((colId / NROF_STACKS) != stackId) {
 
-			const size_t size = m_cells[rowId][colId].size();
-			if (1 == size)
+			const uint16_t cell = m_cells[rowId][colId];
+			if ((1 == bitCount(cell)) || (0 == (cell & mask)))
 				continue;
 
-			m_cells[rowId][colId].remove(val);
-
-			if(m_cells[rowId][colId].size() < size)
-				result++;
+			setCell(rowId, colId, cell & ~mask);
+			result++;
 		}
 	}
 
@@ -957,13 +2378,13 @@ uint32_t CSudokuGrid::removeInRow(const uint16_t rowId, const uint16_t stackId,
 }
 
 /**
- * Removes all candidates equal to 'val' from a given column 
+ * Removes all candidates within 'mask' from a given column, except for the cells of the given band
  */
-uint32_t CSudokuGrid::removeInCol(const uint16_t colId, const uint16_t bandId, const char val)
+uint32_t CSudokuGrid::removeInCol(const uint16_t colId, const uint16_t bandId, const uint16_t mask)
 {
 	assert(colId < NROF_COLS);
 	assert(bandId < NROF_BANDS);
-	assert(val >= 49); assert(val <= 57); // '1' = 49, '9' = 57
+	assert(0 == (mask & ~ALL_CANDIDATES));
 
 	uint32_t result = 0;
 
@@ -971,14 +2392,12 @@ uint32_t CSudokuGrid::removeInCol(const uint16_t colId, const uint16_t bandId, c
 
 		if ((rowId / NROF_BANDS) != bandId) {
 
-			const size_t size = m_cells[rowId][colId].size();
-			if (1 == size)
+			const uint16_t cell = m_cells[rowId][colId];
+			if ((1 == bitCount(cell)) || (0 == (cell & mask)))
 				continue;
 
-			m_cells[rowId][colId].remove(val);
-
-			if (m_cells[rowId][colId].size() < size)
-				result++;
+			setCell(rowId, colId, cell & ~mask);
+			result++;
 		}
 	}
 
@@ -986,24 +2405,24 @@ uint32_t CSudokuGrid::removeInCol(const uint16_t colId, const uint16_t bandId, c
 }
 
 /**
- *  Provides all candidates and their coordinates from a given box
+ *  Provides all candidates of the non assigned cells from a given box ('cand') and 
+ *  the ones that appear in more than one cell ('candTwice')
  */
-void CSudokuGrid::sumBox(const uint16_t bandId, const uint16_t stackId, std::list<char>& cand, std::vector<cellPos_t>& candPos) 
+void CSudokuGrid::sumBox(const uint16_t bandId, const uint16_t stackId, uint16_t &cand, uint16_t &candTwice) 
 {
+	cand = 0;
+	candTwice = 0;
+
 	for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
 
 		for (uint16_t colId = 0; colId < (NROF_COLS / NROF_STACKS); colId++) {
 
-			const cellPos_t cellPos{ (uint16_t)(bandId * (NROF_ROWS / NROF_BANDS) + rowId), (uint16_t)(stackId * (NROF_COLS / NROF_STACKS) + colId) };
-
-			if (1 < m_cells[cellPos.rowId][cellPos.colId].size()) {
+			const uint16_t cell = m_cells[bandId * (NROF_ROWS / NROF_BANDS) + rowId][stackId * (NROF_COLS / NROF_STACKS) + colId];
 
-				std::list<char> &cell = m_cells[cellPos.rowId][cellPos.colId];
-				cand.insert(cand.end(), cell.begin(), cell.end());
+			if (1 < bitCount(cell)) {
 
-				for (std::list<char>::iterator it = cell.begin(); it != cell.end(); ++it) {
-					candPos.push_back({ cellPos.rowId, cellPos.colId });
-				}
+				candTwice |= cand & cell;
+				cand |= cell;
 			}
 		}
 	}
@@ -1018,26 +2437,21 @@ int CSudokuGrid::searchBox(uint16_t &bestBandId, uint16_t &bestStackId, size_t &
 
 	bestBandId = 0;
 	bestStackId = 0;
-	bestSize = NROF_ROWS;
+	bestSize = NROF_VALUES + 1;
 
 	for (uint16_t bandId = 0; bandId < NROF_BANDS; bandId++) {
 
 		for (uint16_t stackId = 0; stackId < NROF_STACKS; stackId++) {
 
-			std::list<char> cand;
-			std::vector<cellPos_t> candPos;
+			uint16_t cand, candTwice;
 
-			sumBox(bandId, stackId, cand, candPos);
+			sumBox(bandId, stackId, cand, candTwice);
 			
-			if (0 == cand.size()) {
+			if (0 == cand) {
 				continue;
 			}
 
-			std::list<char> candUnique = cand;
-			candUnique.sort();
-			candUnique.unique();
-
-			const size_t size = candUnique.size();
+			const size_t size = bitCount(cand);
 			if (size < bestSize) {
 
 				bestBandId = bandId;
@@ -1047,7 +2461,7 @@ int CSudokuGrid::searchBox(uint16_t &bestBandId, uint16_t &bestStackId, size_t &
 		}
 	}
 
-	if (NROF_ROWS == bestSize) {
+	if ((NROF_VALUES + 1) == bestSize) {
 		retVal = NOT_VALID;
 	}
 	
@@ -1066,14 +2480,14 @@ int CSudokuGrid::searchCell(const uint16_t bandId, const uint16_t stackId, uint1
 
 	bestRowId = 0;
 	bestColId = 0;
-	bestSize = NROF_BANDS;
+	bestSize = NROF_VALUES + 1;
 
 	for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
 
 		for (uint16_t colId = 0; colId < (NROF_COLS / NROF_STACKS); colId++) {
 
 			const cellPos_t cellPos{ (uint16_t)(bandId * (NROF_ROWS / NROF_BANDS) + rowId), (uint16_t)(stackId * (NROF_COLS / NROF_STACKS) + colId) };
-			const size_t size = m_cells[cellPos.rowId][cellPos.colId].size();
+			const size_t size = bitCount(m_cells[cellPos.rowId][cellPos.colId]);
 
 			if (1 == size) {
 				continue;
@@ -1091,7 +2505,7 @@ int CSudokuGrid::searchCell(const uint16_t bandId, const uint16_t stackId, uint1
 	bestRowId += bandId * (NROF_ROWS / NROF_BANDS);
 	bestColId += stackId * (NROF_COLS / NROF_STACKS);
 
-	if (NROF_BANDS == bestSize) {
+	if ((NROF_VALUES + 1) == bestSize) {
 		retVal = NOT_VALID;
 	}
 	
@@ -1112,25 +2526,71 @@ void CSudokuGrid::searchAllCells(const char val, const uint8_t level, std::vecto
 
 		for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
 
-			if ((MASKED_CELL == GEN_MASK[level][rowId][colId]) || (1 == m_cells[rowId][colId].size())) {
+			if ((MASKED_CELL == GEN_MASK[level][rowId][colId]) || (1 == bitCount(m_cells[rowId][colId]))) {
 				continue;
 			}
 
-			std::list<char>::iterator it;
-			it = std::find(m_cells[rowId][colId].begin(), m_cells[rowId][colId].end(), val);
-
-			if (it != m_cells[rowId][colId].end()) {
+			if (m_cells[rowId][colId] & valToBit(val)) {
 
 				candPos.push_back(cellPos_t{ rowId, colId });
 			}
 		}
 	}
 
-	if (random) {
+	if (random && m_random) {
+		shuffle(candPos, *m_random);
+	}
+}
+
+/**
+ * Recursive step of fillGrid. Same as searchTrail, with the candidates of the 'best cell' shuffled
+ */
+int CSudokuGrid::fillTrail()
+{
+	size_t size;
+	uint16_t bandId, stackId;
+	uint16_t rowId, colId;
+
+	if (NOT_VALID == searchBox(bandId, stackId, size)) {
+		return NOT_VALID;
+	}
+
+	if (NOT_VALID == searchCell(bandId, stackId, rowId, colId, size)) {
+		return NOT_VALID;
+	}
+
+	const uint32_t trailMark = m_trailTop;
+	const uint64_t dirty = m_dirty;
+
+	std::vector<char> values;
+
+	for (uint16_t mask = m_cells[rowId][colId]; mask; mask &= (mask - 1)) {
+		values.push_back(bitToVal(mask));
+	}
+
+	shuffle(values, *m_random);
+
+	uint32_t iter = 0;
+
+	for (std::vector<char>::iterator it = values.begin(); it != values.end(); ++it) {
 
-		uint32_t seed = (uint32_t)std::chrono::system_clock::now().time_since_epoch().count();
-		std::shuffle(candPos.begin(), candPos.end(), std::default_random_engine(seed));
+		assign(rowId, colId, *it);
+
+		int retVal = checkGrid(iter, false);
+
+		if (VALID_NOT_SOLVED == retVal) {
+			retVal = fillTrail();
+		}
+
+		if (VALID_SOLVED == retVal) {
+			return retVal;
+		}
+
+		undo(trailMark);
+		m_dirty = dirty;
 	}
+
+	return NOT_VALID;
 }
 
 /**
@@ -1151,7 +2611,7 @@ int CSudokuGrid::countVal(const char val, const uint8_t level)
 				continue;
 			}
 
-			if ((1 == m_cells[rowId][colId].size()) && (val == m_cells[rowId][colId].front())) {
+			if (valToBit(val) == m_cells[rowId][colId]) {
 				result++;
 			}
 		}
@@ -1190,6 +2650,11 @@ int CSudokuGrid::chance(std::vector<char>& val, const uint8_t level)
 	int retVal = VALID_NOT_SOLVED;
 
 	if ('0' == nextVal) {
+
+		// Puzzles with more than one solution are discarded
+		if (1 != countSolutions(2)) {
+			return NOT_VALID;
+		}
 		
 		uint32_t iter;
 		return solve(iter, false);
@@ -1203,16 +2668,16 @@ int CSudokuGrid::chance(std::vector<char>& val, const uint8_t level)
 		return VALID_NOT_SOLVED;
 	}
 
-	uint32_t iter;
-	CSudokuGrid gridCpy;
+	uint32_t iter = 0;
+	const uint32_t trailMark = m_trailTop;
+	const uint64_t dirty = m_dirty;
 
 	std::vector<cellPos_t>::iterator pos;
 	for (pos = candPos.begin(); pos != candPos.end(); ++pos) {
 		
-		gridCpy = *this;
-		gridCpy.assign((*pos).rowId, (*pos).colId, nextVal);
+		assign((*pos).rowId, (*pos).colId, nextVal);
 
-		retVal = gridCpy.checkGrid(iter, false);
+		retVal = checkGrid(iter, false);
 
 		if (VALID_SOLVED == retVal) {
 			return retVal;
@@ -1220,18 +2685,22 @@ int CSudokuGrid::chance(std::vector<char>& val, const uint8_t level)
 
 		if (VALID_NOT_SOLVED == retVal) {
 			
-			retVal = gridCpy.chance(val, level);
+			retVal = chance(val, level);
 
 			if (VALID_SOLVED == retVal) {
-				
-				*this = gridCpy;
 				return retVal;
 			}
 
 			if (NOT_VALID == retVal) {
+
+				undo(trailMark);
+				m_dirty = dirty;
 				return retVal;
 			}
 		}
+
+		undo(trailMark);
+		m_dirty = dirty;
 	}
 
 	if ((candPos.end() == pos) && (VALID_NOT_SOLVED == retVal)) {
@@ -1250,7 +2719,9 @@ void CSudokuGrid::initGrid()
 
 		for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
 
-			m_cells[rowId][colId] = from1to9; // 1 to 9
+			m_cells[rowId][colId] = ALL_CANDIDATES; // 1 to 9
 		}
 	}
+
+	updateMasks();
 }
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <list>
+#include <random>
 #include <cassert>
+#include <cstdint>
+#include <string>
 #include <vector>
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 
 #define NROF_ROWS (9)
 #define NROF_COLS (9)
@@ -11,9 +19,57 @@
 #define NROF_BANDS (3)
 #define NROF_STACKS (3)
 
+#define NROF_VALUES (9)
+
+// Units (rows, columns and boxes) of the grid, numbered in that order
+#define NROF_UNITS (NROF_ROWS + NROF_COLS + NROF_BANDS * NROF_STACKS)
+#define ALL_UNITS ((uint32_t)((1 << NROF_UNITS) - 1))
+
+// Bits of the work queue after the units, each one queues a group of the constraints of a variant (see CSudokuConstraints)
+#define NROF_CONSTRAINT_GROUPS (64 - NROF_UNITS)
+
+// Candidate mask with all possible values for a cell. Bit 0 stands for '1', bit 8 for '9'
+#define ALL_CANDIDATES ((uint16_t)0x01FF)
+
+// Maximum number of changes recorded in the trail while searching. Cells only lose candidates
+// and rows, columns and boxes only gain assigned values, so each of them changes at most 9 times
+#define TRAIL_SIZE ((NROF_ROWS * NROF_COLS + NROF_UNITS) * NROF_VALUES + 1)
+
+// The parallel search expands the first levels of the search tree until there are enough
+// subtrees for every thread, without going deeper than PARALLEL_MAX_DEPTH levels
+#define PARALLEL_TASKS_PER_THREAD (8)
+#define PARALLEL_MAX_DEPTH (4)
+
 // Resulting states of Sudoku solver
 enum { NOT_VALID = -1, VALID_NOT_SOLVED = 0, VALID_SOLVED = 1};
 
+// Statistics of a solver run
+typedef struct {
+	uint32_t iter;          // Iterations of the analysis (basic) techniques
+	uint32_t branches;      // Values tried on a branching cell
+	uint32_t backtracks;    // Branches undone because they did not lead to a solution
+	uint32_t maxDepth;      // Deepest nesting of branching cells
+	uint32_t maxTrailDepth; // Most entries used in the trail
+} searchStats_t;
+
+// Engines available for the brute force part of the solver
+enum { ENGINE_BACKTRACK = 0, ENGINE_DLX = 1 };
+
+// Advanced techniques applied by checkGrid once the basic ones make no more progress (see setLogic)
+enum {
+	LOGIC_NAKED_PAIRS = 0x01,
+	LOGIC_HIDDEN_PAIRS = 0x02,
+	LOGIC_NAKED_TRIPLES = 0x04,
+	LOGIC_HIDDEN_TRIPLES = 0x08,
+	LOGIC_NAKED_QUADS = 0x10,
+	LOGIC_HIDDEN_QUADS = 0x20,
+	LOGIC_XWING = 0x40,
+	LOGIC_SWORDFISH = 0x80
+};
+
+#define LOGIC_NONE (0)
+#define LOGIC_ALL (0xFF)
+
 // Levels of difficulty for Sudoku grid generation
 enum { EASY = 0, MEDIUM = 1, HARD = 2, SAMURAI = 3};
 
@@ -96,22 +152,101 @@ const uint8_t REP_PATT[NROF_LEVELS][NROF_ROWS] = {
 	{2, 2, 2, 2, 3, 3, 3, 3, 4}  // samurai
 };
 
+// Clues kept by the pattern-free generator for each level, as many as in the masks above
+const uint8_t GEN_CLUES[NROF_LEVELS] = { 32, 28, 24, 24 };
+
+// Clues of generated puzzles: the GEN_MASK of the level, or pattern-free, removing clues from a full grid 
+// in pairs symmetric about the centre or one at a time anywhere
+enum { MASK_LEVEL = 0, MASK_SYMMETRIC = 1, MASK_RANDOM = 2 };
+
 // List containing all possible values for a cell
 const std::list<char> from1to9({ 49, 50, 51, 52, 53, 54, 55, 56, 57 }); // '1' = 49, '9' = 57
 
+/**
+ * Number of candidates in a cell mask
+ */
+inline uint32_t bitCount(const uint32_t mask)
+{
+#if defined(_MSC_VER)
+	return __popcnt(mask);
+#elif defined(__POPCNT__)
+	return (uint32_t)__builtin_popcount(mask);
+#else
+	// Without the popcnt instruction the builtin becomes a library call, count the bits in parallel instead
+	uint32_t count = mask - ((mask >> 1) & 0x55555555);
+	count = (count & 0x33333333) + ((count >> 2) & 0x33333333);
+	count = (count + (count >> 4)) & 0x0F0F0F0F;
+
+	return (count * 0x01010101) >> 24;
+#endif
+}
+
+/**
+ * Position of the lowest candidate in a (non empty) cell mask
+ */
+inline uint32_t bitIndex(const uint32_t mask)
+{
+	assert(mask);
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return (uint32_t)__builtin_ctz(mask);
+#endif
+}
+
+/**
+ * Same as above, for a (non empty) mask of 64 bits
+ */
+inline uint32_t bitIndex64(const uint64_t mask)
+{
+	assert(mask);
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return index;
+#elif defined(_MSC_VER)
+	return ((uint32_t)mask) ? bitIndex((uint32_t)mask) : (32 + bitIndex((uint32_t)(mask >> 32)));
+#else
+	return (uint32_t)__builtin_ctzll(mask);
+#endif
+}
+
+/**
+ * Conversions between a value ('1' = 49, '9' = 57) and its bit in a cell mask
+ */
+inline uint16_t valToBit(const char val)
+{
+	return (uint16_t)(1 << (val - 49));
+}
+
+inline char bitToVal(const uint16_t bit)
+{
+	return (char)(49 + bitIndex(bit));
+}
+
+
+class CSudokuConstraints;
+class CSudokuCache;
 
 class CSudokuGrid
 {
 public:
 	CSudokuGrid();
+	CSudokuGrid(const CSudokuGrid &grid);
 	~CSudokuGrid();
 
-	CSudokuGrid operator= (const CSudokuGrid &grid);
+	CSudokuGrid &operator= (const CSudokuGrid &grid);
 
 	bool readGrid(const std::string &fileName);
+	bool readLine(const char *line, const size_t length);
+	void readCandidates(const uint16_t cells[NROF_ROWS][NROF_COLS]);
+	void writeLine(char *line, const uint8_t level = NROF_LEVELS) const;
 
 	void assign(const uint16_t rowId, const uint16_t colId, const char value);
 	std::list<char> getCell(const uint16_t rowId, const uint16_t colId) const;
+	uint16_t getCandidates(const uint16_t rowId, const uint16_t colId) const;
 	
 
 	uint32_t checkRow(const uint16_t rowId);
@@ -122,8 +257,25 @@ public:
 	uint32_t checkBox(const uint16_t bandId, const uint16_t stackId);
 	uint32_t checkBoxes(const uint16_t bandFirstId = 0, const uint16_t bandLastId = (NROF_BANDS - 1), const uint16_t stackFirstId = 0, const uint16_t stackLastId = (NROF_STACKS - 1));
 
+	uint32_t hiddenSingleRow(const uint16_t rowId);
+	uint32_t hiddenSingleColumn(const uint16_t colId);
 	uint32_t hiddenSingleBox(const uint16_t bandId, const uint16_t stackId);
 
+	uint32_t nakedSubset(const uint32_t unitId, const uint32_t size);
+	uint32_t hiddenSubset(const uint32_t unitId, const uint32_t size);
+	uint32_t fish(const uint32_t size, const bool byRow);
+
+	void setLogic(const uint32_t logic);
+	uint32_t getLogic() const;
+	uint32_t checkLogic();
+
+	void setConstraints(const CSudokuConstraints *constraints);
+	const CSudokuConstraints *getConstraints() const;
+	uint32_t checkConstraints(const uint32_t groupId);
+
+	void setCache(CSudokuCache *cache);
+	CSudokuCache *getCache() const;
+
 	uint32_t checkBand(const uint16_t bandId);
 	uint32_t checkBands(const uint16_t bandFirstId = 0, const uint16_t bandLastId = (NROF_BANDS - 1));
 	uint32_t checkStack(const uint16_t stackId);
@@ -131,9 +283,14 @@ public:
 	
 	int checkGrid(uint32_t &iter, const bool show = true);
 	int search(uint32_t &iter, const bool show = true);
+	int search(searchStats_t &stats, const bool show = true);
+	int searchParallel(searchStats_t &stats, const uint32_t nrofThreads, const bool show = true);
+	uint32_t countSolutions(const uint32_t limit = 2);
 
 	int solve(uint32_t &iter, const bool show = true);
+	int solve(searchStats_t &stats, const bool show = true, const int engine = ENGINE_BACKTRACK, const uint32_t nrofThreads = 1);
 	bool isSolved();
+	bool hasConflict() const;
 
 	bool IsRowValid(const uint16_t rowId);
 	bool IsColValid(const uint16_t colId);
@@ -148,29 +305,86 @@ public:
 	void dumpCol(const uint16_t colId);
 	void dumpBox(const uint16_t bandId, const uint16_t stackId);
 
-	int generate(const uint8_t level = EASY);
+	int generate(const uint8_t level = EASY, const bool show = true);
+	int generate(const uint8_t level, std::mt19937 &random, const bool show = true);
+	int generate(const uint8_t level, const uint64_t seed, const uint64_t number, const bool show = true);
+
+	uint32_t generateClues(const uint32_t nrofClues, const uint8_t mask, std::mt19937 &random);
+	bool fillGrid(std::mt19937 &random);
+
+	static void seedRandom(std::mt19937 &random, const uint64_t seed, const uint64_t number);
 
 private:
-	std::list<char> m_cells[NROF_ROWS][NROF_COLS];
+	// Candidates of each cell as a mask of values (see ALL_CANDIDATES)
+	uint16_t m_cells[NROF_ROWS][NROF_COLS];
+
+	// Values already assigned within each row, column and box
+	uint16_t m_rowMask[NROF_ROWS];
+	uint16_t m_colMask[NROF_COLS];
+	uint16_t m_boxMask[NROF_BANDS][NROF_STACKS];
+
+	// Set when a cell runs out of candidates or a value is assigned twice within a unit
+	uint16_t m_conflict;
+
+	// Work queue of the units that lost candidates and need to be analysed again (bit per unit), followed
+	// by the groups of constraints of the variant
+	uint64_t m_dirty;
+
+	// Advanced techniques enabled (see LOGIC_ALL)
+	uint32_t m_logic;
+
+	// Constraints of the variant on top of the rows, columns and boxes, not owned by the grid
+	const CSudokuConstraints *m_constraints;
+
+	// Solutions of the puzzles solved before, looked up by solve(), not owned by the grid
+	CSudokuCache *m_cache;
+
+	// Undo log of the changes done while searching, not owned by the grid
+	typedef struct { uint16_t *word; uint16_t value; } trailEntry_t;
+
+	trailEntry_t *m_trail;
+	uint32_t m_trailTop;
+
+	// Raised by another thread when the search is no longer needed, not owned by the grid
+	const std::atomic<bool> *m_cancel;
+
+	// Random generator of the puzzle being generated, not owned by the grid
+	std::mt19937 *m_random;
 
 private:
 	typedef struct { uint16_t rowId; uint16_t colId; } cellPos_t;
 
-	void pushBack(const uint16_t rowId, const uint16_t colId, const char value);
-	void notAssigned(const uint16_t rowId, const uint16_t colId);
+	void store(uint16_t &word, const uint16_t value);
+	void undo(const uint32_t trailMark);
+
+	void setCell(const uint16_t rowId, const uint16_t colId, const uint16_t mask);
+	void updateMasks();
 
-	uint32_t remove(std::vector<char> &assigned, std::vector<cellPos_t> &nonAssignedPos);
-	uint32_t removeInRow(const uint16_t rowId, const uint16_t stackId, const char val);
-	uint32_t removeInCol(const uint16_t colId, const uint16_t bandId, const char val);
+	uint32_t checkUnit(const uint32_t unitId);
+	uint32_t hiddenSingle(const uint32_t unitId);
+	uint32_t checkExtraUnit(const uint32_t constraintId);
+	uint32_t checkCage(const uint32_t constraintId);
+	uint32_t checkExclusion(const uint32_t constraintId);
+	uint32_t pointRow(const uint16_t bandId, const uint16_t stackId);
+	uint32_t pointCol(const uint16_t bandId, const uint16_t stackId);
+
+	uint32_t removeInRow(const uint16_t rowId, const uint16_t stackId, const uint16_t mask);
+	uint32_t removeInCol(const uint16_t colId, const uint16_t bandId, const uint16_t mask);
 	
-	void sumBox(const uint16_t bandId, const uint16_t stackId, std::list<char> &cand, std::vector<cellPos_t> &candPos);
+	void sumBox(const uint16_t bandId, const uint16_t stackId, uint16_t &cand, uint16_t &candTwice);
 	
+	int searchTrail(searchStats_t &stats, const uint32_t depth, const bool show);
+	void countTrail(uint32_t &count, const uint32_t limit);
+	int branch(std::vector<CSudokuGrid> &children, searchStats_t &stats, const uint32_t depth);
 	int searchBox(uint16_t &bestBandId, uint16_t &bestStackId, size_t &bestSize);
 	int searchCell(const uint16_t bandId, const uint16_t stackId, uint16_t &bestRowId, uint16_t &bestColId, size_t &bestSize);
 	void searchAllCells(const char val, const uint8_t level, std::vector<cellPos_t> &candPos, bool random = true);
 
 	int countVal(const char val, const uint8_t level = NROF_LEVELS);
 	int chance(std::vector<char> &val, const uint8_t level);
+	int fillTrail();
+
+	int solveGrid(searchStats_t &stats, const bool show, const int engine, const uint32_t nrofThreads);
 
 	void initGrid();
 };
@@ -0,0 +1,378 @@
+#include "SudokuKernels.h"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SUDOKU_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+#if defined(SUDOKU_KERNELS_X86) && !defined(_MSC_VER)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+using namespace std;
+
+// Lanes of a row within the vector kernels, 9 cells followed by empty lanes
+#define ROW_LANES (16)
+
+// Bits of the byte mask of a padded row that belong to its 9 cells (two bytes per cell)
+#define ROW_BYTES ((uint32_t)((1 << (2 * NROF_COLS)) - 1))
+
+// Names of the kernels, as printed
+static const char *KERNEL_NAME[NROF_KERNELS] = { "scalar", "sse2", "avx2" };
+
+// Partial results of the vector kernels, finished by finishScan
+typedef struct {
+	// Values assigned within each row and columns, bytes of the cells assigned within each row
+	uint16_t rowMask[NROF_ROWS];
+	uint32_t rowAssigned[NROF_ROWS];
+	alignas(32) uint16_t colMask[ROW_LANES];
+
+	// Values assigned within each column of every band, one lane per column
+	alignas(32) uint16_t bandMask[NROF_BANDS][ROW_LANES];
+
+	// A cell without candidates was found, or a value assigned twice within a column
+	bool conflict;
+} scanParts_t;
+
+typedef void (*scanKernel_t)(const uint16_t cells[NROF_ROWS][NROF_COLS], unitScan_t &scan);
+
+/**
+ * Counts the cells of a box (stack 'stackId') marked in the byte masks of the rows of a band
+ */
+static inline uint32_t countBox(const uint32_t *rowAssigned, const uint16_t stackId)
+{
+	const uint32_t bytes = ((1 << (2 * (NROF_COLS / NROF_STACKS))) - 1) << (2 * (NROF_COLS / NROF_STACKS) * stackId);
+
+	uint32_t count = 0;
+
+	for (uint16_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
+		count += bitCount(rowAssigned[rowId] & bytes);
+	}
+
+	return count / 2;
+}
+
+/**
+ * Builds the masks of the rows, columns and boxes from the partial results of a vector kernel and checks
+ * that every row and box has as many values as cells assigned
+ */
+static void finishScan(const scanParts_t &parts, unitScan_t &scan)
+{
+	scan.valid = (false == parts.conflict);
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		scan.rows[rowId] = parts.rowMask[rowId];
+		scan.valid = scan.valid && (bitCount(parts.rowMask[rowId]) == bitCount(parts.rowAssigned[rowId]) / 2);
+	}
+
+	for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+		scan.cols[colId] = parts.colMask[colId];
+	}
+
+	for (uint16_t bandId = 0; bandId < NROF_BANDS; bandId++) {
+
+		for (uint16_t stackId = 0; stackId < NROF_STACKS; stackId++) {
+
+			const uint16_t *lanes = &parts.bandMask[bandId][stackId * (NROF_COLS / NROF_STACKS)];
+			const uint16_t mask = lanes[0] | lanes[1] | lanes[2];
+
+			scan.boxes[bandId * NROF_STACKS + stackId] = mask;
+			scan.valid = scan.valid && (bitCount(mask) == countBox(&parts.rowAssigned[bandId * (NROF_ROWS / NROF_BANDS)], stackId));
+		}
+	}
+}
+
+/**
+ * Portable kernel, one cell at a time
+ */
+static void scanScalar(const uint16_t cells[NROF_ROWS][NROF_COLS], unitScan_t &scan)
+{
+	uint32_t rowCount[NROF_ROWS] = { 0 };
+	uint32_t colCount[NROF_COLS] = { 0 };
+	uint32_t boxCount[NROF_BANDS * NROF_STACKS] = { 0 };
+
+	memset(scan.rows, 0, sizeof(scan.rows));
+	memset(scan.cols, 0, sizeof(scan.cols));
+	memset(scan.boxes, 0, sizeof(scan.boxes));
+
+	scan.valid = true;
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+
+			const uint16_t cell = cells[rowId][colId];
+			const uint16_t boxId = (rowId / (NROF_ROWS / NROF_BANDS)) * NROF_STACKS + colId / (NROF_COLS / NROF_STACKS);
+
+			if (0 == cell) {
+				scan.valid = false;
+			}
+
+			// Only assigned cells, the ones with a single candidate, add their value to the units
+			if (cell & (cell - 1)) {
+				continue;
+			}
+
+			scan.rows[rowId] |= cell;
+			scan.cols[colId] |= cell;
+			scan.boxes[boxId] |= cell;
+
+			rowCount[rowId]++;
+			colCount[colId]++;
+			boxCount[boxId]++;
+		}
+	}
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+		scan.valid = scan.valid && (bitCount(scan.rows[rowId]) == rowCount[rowId]);
+	}
+
+	for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+		scan.valid = scan.valid && (bitCount(scan.cols[colId]) == colCount[colId]);
+	}
+
+	for (uint16_t boxId = 0; boxId < (NROF_BANDS * NROF_STACKS); boxId++) {
+		scan.valid = scan.valid && (bitCount(scan.boxes[boxId]) == boxCount[boxId]);
+	}
+}
+
+#if defined(SUDOKU_KERNELS_X86)
+
+/**
+ * SSE2 kernel, two vectors of 8 lanes per row (the 9 cells and empty lanes)
+ */
+static void scanSSE2(const uint16_t cells[NROF_ROWS][NROF_COLS], unitScan_t &scan)
+{
+	scanParts_t parts;
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(1);
+
+	__m128i colLo = zero, colHi = zero;
+	__m128i twice = zero;
+	__m128i bandLo = zero, bandHi = zero;
+	uint32_t empty = 0;
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		// Columns 0 to 7 in a single load, column 8 alone in the first lane of the second vector
+		const __m128i lo = _mm_loadu_si128((const __m128i *)cells[rowId]);
+		const __m128i hi = _mm_cvtsi32_si128(cells[rowId][8]);
+
+		// Cells with a single candidate keep it, the rest become 0
+		const __m128i singleLo = _mm_and_si128(lo, _mm_cmpeq_epi16(_mm_and_si128(lo, _mm_sub_epi16(lo, one)), zero));
+		const __m128i singleHi = _mm_and_si128(hi, _mm_cmpeq_epi16(_mm_and_si128(hi, _mm_sub_epi16(hi, one)), zero));
+
+		empty |= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(lo, zero)) | ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(hi, zero)) << 16);
+
+		parts.rowAssigned[rowId] = ~((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(singleLo, zero)) | ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi16(singleHi, zero)) << 16)) & ROW_BYTES;
+
+		// Columns, lane by lane
+		twice = _mm_or_si128(twice, _mm_or_si128(_mm_and_si128(colLo, singleLo), _mm_and_si128(colHi, singleHi)));
+		colLo = _mm_or_si128(colLo, singleLo);
+		colHi = _mm_or_si128(colHi, singleHi);
+
+		// Row, reduced within the vector
+		__m128i row = _mm_or_si128(singleLo, singleHi);
+		row = _mm_or_si128(row, _mm_srli_si128(row, 8));
+		row = _mm_or_si128(row, _mm_srli_si128(row, 4));
+		row = _mm_or_si128(row, _mm_srli_si128(row, 2));
+		parts.rowMask[rowId] = (uint16_t)_mm_cvtsi128_si32(row);
+
+		// Boxes, lane by lane within the band
+		bandLo = _mm_or_si128(bandLo, singleLo);
+		bandHi = _mm_or_si128(bandHi, singleHi);
+
+		if (((NROF_ROWS / NROF_BANDS) - 1) == (rowId % (NROF_ROWS / NROF_BANDS))) {
+
+			const uint16_t bandId = rowId / (NROF_ROWS / NROF_BANDS);
+
+			_mm_store_si128((__m128i *)&parts.bandMask[bandId][0], bandLo);
+			_mm_store_si128((__m128i *)&parts.bandMask[bandId][8], bandHi);
+
+			bandLo = zero;
+			bandHi = zero;
+		}
+	}
+
+	_mm_store_si128((__m128i *)&parts.colMask[0], colLo);
+	_mm_store_si128((__m128i *)&parts.colMask[8], colHi);
+
+	parts.conflict = (0 != (empty & ROW_BYTES)) || (0xFFFF != _mm_movemask_epi8(_mm_cmpeq_epi16(twice, zero)));
+
+	finishScan(parts, scan);
+}
+
+/**
+ * AVX2 kernel, one vector of 16 lanes per row
+ */
+TARGET_AVX2 static void scanAVX2(const uint16_t cells[NROF_ROWS][NROF_COLS], unitScan_t &scan)
+{
+	scanParts_t parts;
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi16(1);
+
+	__m256i col = zero;
+	__m256i twice = zero;
+	__m256i band = zero;
+	uint32_t empty = 0;
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		// Same lanes as the SSE2 kernel, the row is not loaded as a whole to stay within the grid
+		const __m256i cell = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)cells[rowId])), _mm_cvtsi32_si128(cells[rowId][8]), 1);
+		const __m256i single = _mm256_and_si256(cell, _mm256_cmpeq_epi16(_mm256_and_si256(cell, _mm256_sub_epi16(cell, one)), zero));
+
+		empty |= (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(cell, zero));
+
+		parts.rowAssigned[rowId] = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(single, zero)) & ROW_BYTES;
+
+		twice = _mm256_or_si256(twice, _mm256_and_si256(col, single));
+		col = _mm256_or_si256(col, single);
+
+		__m128i row = _mm_or_si128(_mm256_castsi256_si128(single), _mm256_extracti128_si256(single, 1));
+		row = _mm_or_si128(row, _mm_srli_si128(row, 8));
+		row = _mm_or_si128(row, _mm_srli_si128(row, 4));
+		row = _mm_or_si128(row, _mm_srli_si128(row, 2));
+		parts.rowMask[rowId] = (uint16_t)_mm_cvtsi128_si32(row);
+
+		band = _mm256_or_si256(band, single);
+
+		if (((NROF_ROWS / NROF_BANDS) - 1) == (rowId % (NROF_ROWS / NROF_BANDS))) {
+
+			_mm256_store_si256((__m256i *)parts.bandMask[rowId / (NROF_ROWS / NROF_BANDS)], band);
+			band = zero;
+		}
+	}
+
+	_mm256_store_si256((__m256i *)parts.colMask, col);
+
+	parts.conflict = (0 != (empty & ROW_BYTES)) || (0 == _mm256_testz_si256(twice, twice));
+
+	// The rest of the code is not built for AVX, leaving the upper halves dirty slows it down
+	_mm256_zeroupper();
+
+	finishScan(parts, scan);
+}
+
+#endif
+
+/**
+ * Whether the CPU (and the build) can run a kernel
+ */
+bool isKernelSupported(const int kernel)
+{
+	switch (kernel) {
+
+	case KERNEL_SCALAR:
+		return true;
+
+#if defined(SUDOKU_KERNELS_X86)
+	case KERNEL_SSE2:
+		return true;
+
+	case KERNEL_AVX2:
+#if defined(_MSC_VER)
+	{
+		int info[4];
+
+		// The CPU needs AVX2 and the operating system needs to save the AVX registers
+		__cpuid(info, 1);
+
+		if ((0 == (info[2] & (1 << 27))) || (0 == (info[2] & (1 << 28))) || (6 != (_xgetbv(0) & 6))) {
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (0 != (info[1] & (1 << 5)));
+	}
+#else
+		return (0 != __builtin_cpu_supports("avx2"));
+#endif
+#endif
+
+	default:
+		return false;
+	}
+}
+
+/**
+ * Fastest kernel supported
+ */
+int bestKernel()
+{
+	int kernel = NROF_KERNELS - 1;
+
+	while (false == isKernelSupported(kernel)) {
+		kernel--;
+	}
+
+	return kernel;
+}
+
+/**
+ * Name of a kernel
+ */
+const char *kernelName(const int kernel)
+{
+	assert((kernel >= 0) && (kernel < NROF_KERNELS));
+
+	return KERNEL_NAME[kernel];
+}
+
+/**
+ * Function of a kernel, nullptr when it is not supported
+ */
+static scanKernel_t kernelFunction(const int kernel)
+{
+	if (false == isKernelSupported(kernel)) {
+		return nullptr;
+	}
+
+	switch (kernel) {
+
+#if defined(SUDOKU_KERNELS_X86)
+	case KERNEL_SSE2:
+		return scanSSE2;
+
+	case KERNEL_AVX2:
+		return scanAVX2;
+#endif
+
+	default:
+		return scanScalar;
+	}
+}
+
+/**
+ * Scans the units of a grid with the fastest kernel supported
+ */
+void scanUnits(const uint16_t cells[NROF_ROWS][NROF_COLS], unitScan_t &scan)
+{
+	static const scanKernel_t function = kernelFunction(bestKernel());
+
+	function(cells, scan);
+}
+
+/**
+ * Scans the units of a grid with the given kernel. Returns false, leaving 'scan' untouched, when the
+ * kernel is not supported
+ */
+bool scanUnits(const uint16_t cells[NROF_ROWS][NROF_COLS], unitScan_t &scan, const int kernel)
+{
+	const scanKernel_t function = kernelFunction(kernel);
+
+	if (nullptr == function) {
+		return false;
+	}
+
+	function(cells, scan);
+	return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#include "SudokuGrid.h"
+
+
+// Implementations of the unit scan, from the most portable to the fastest
+enum { KERNEL_SCALAR = 0, KERNEL_SSE2, KERNEL_AVX2, NROF_KERNELS };
+
+// Values assigned within each row, column and box of a grid, and whether it still fulfills the rules
+typedef struct {
+	uint16_t rows[NROF_ROWS];
+	uint16_t cols[NROF_COLS];
+	uint16_t boxes[NROF_BANDS * NROF_STACKS];
+	bool valid;
+} unitScan_t;
+
+
+/**
+ * Scans the candidates of the 81 cells of a grid (CSudokuGrid layout, row after row) in a single pass:
+ * collects the values assigned within each of the 27 units and checks that no cell ran out of candidates
+ * and that no value is assigned twice within a unit.
+ *
+ * The SSE2 and AVX2 kernels hold a whole row in 16 lanes (9 cells and empty lanes), so the columns are
+ * accumulated lane by lane and the rows are reduced within the vector. A unit is valid when it has as many
+ * assigned cells as bits in the mask of its values. The fastest kernel supported by the CPU is picked the
+ * first time a grid is scanned, the scalar one on other architectures.
+ */
+void scanUnits(const uint16_t cells[NROF_ROWS][NROF_COLS], unitScan_t &scan);
+bool scanUnits(const uint16_t cells[NROF_ROWS][NROF_COLS], unitScan_t &scan, const int kernel);
+
+bool isKernelSupported(const int kernel);
+int bestKernel();
+const char *kernelName(const int kernel);
@@ -0,0 +1,264 @@
+#include "SudokuLanes.h"
+
+#include <cassert>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * Cell (row after row) at position 'slot' (0 to 8) of a unit (see NROF_UNITS)
+ */
+static inline uint32_t unitCellId(const uint32_t unitId, const uint32_t slot)
+{
+	if (unitId < NROF_ROWS) {
+		return unitId * NROF_COLS + slot;
+	}
+
+	if (unitId < (NROF_ROWS + NROF_COLS)) {
+		return slot * NROF_COLS + (unitId - NROF_ROWS);
+	}
+
+	const uint32_t boxId = unitId - NROF_ROWS - NROF_COLS;
+
+	const uint32_t rowId = (boxId / NROF_STACKS) * (NROF_ROWS / NROF_BANDS) + slot / (NROF_COLS / NROF_STACKS);
+	const uint32_t colId = (boxId % NROF_STACKS) * (NROF_COLS / NROF_STACKS) + slot % (NROF_COLS / NROF_STACKS);
+
+	return rowId * NROF_COLS + colId;
+}
+
+/**
+ * All bits set when the cell has a single candidate (or none), 0 otherwise. Written without branches so
+ * that the loops over the lanes can be vectorized
+ */
+static inline uint16_t singleMask(const uint16_t cell)
+{
+	return (uint16_t)(0 - (uint16_t)(0 == (uint16_t)(cell & (cell - 1))));
+}
+
+/**
+ * All bits set when the mask is not 0, 0 otherwise
+ */
+static inline uint16_t anyMask(const uint16_t mask)
+{
+	return (uint16_t)(0 - (uint16_t)(0 != mask));
+}
+
+CSudokuLanes::CSudokuLanes()
+{
+	for (uint32_t laneId = 0; laneId < LANES_WIDTH; laneId++) {
+		load(laneId, nullptr);
+	}
+}
+
+CSudokuLanes::~CSudokuLanes()
+{
+}
+
+/**
+ * Loads the puzzle of a line of 81 characters (see CSudokuGrid::readLine) into a lane. Without a line
+ * the lane is left with all the candidates, which makes no progress and costs nothing to the others
+ */
+void CSudokuLanes::load(const uint32_t laneId, const char *line)
+{
+	assert(laneId < LANES_WIDTH);
+
+	for (uint32_t cellId = 0; cellId < (NROF_ROWS * NROF_COLS); cellId++) {
+
+		const char value = line ? line[cellId] : 0;
+
+		// '1' = 49, '9' = 57
+		m_cells[cellId][laneId] = ((value >= 49) && (value <= 57)) ? valToBit(value) : ALL_CANDIDATES;
+	}
+
+	m_conflict[laneId] = 0;
+}
+
+/**
+ * Applies naked and hidden singles to all the lanes until none of the lanes without conflicts makes any
+ * progress. Returns the number of rounds
+ */
+uint32_t CSudokuLanes::propagate()
+{
+	uint32_t nrofRounds = 0;
+	uint16_t progress;
+
+	do {
+		uint16_t changed[LANES_WIDTH] = { 0 };
+
+		nakedSingles(changed);
+		hiddenSingles(changed);
+
+		nrofRounds++;
+
+		// The lanes in conflict are over, whatever they change
+		progress = 0;
+
+		for (uint32_t laneId = 0; laneId < LANES_WIDTH; laneId++) {
+			progress |= changed[laneId] & ~anyMask(m_conflict[laneId]);
+		}
+
+	} while (progress);
+
+	return nrofRounds;
+}
+
+/**
+ * Removes the values assigned within the row, column and box of every cell from its candidates. A value
+ * assigned twice within a unit, or a cell without candidates, is a conflict
+ */
+void CSudokuLanes::nakedSingles(uint16_t *changed)
+{
+	uint16_t placed[NROF_UNITS][LANES_WIDTH];
+
+	for (uint32_t unitId = 0; unitId < NROF_UNITS; unitId++) {
+
+		uint16_t twice[LANES_WIDTH] = { 0 };
+		uint16_t *unitPlaced = placed[unitId];
+
+		memset(unitPlaced, 0, sizeof(placed[unitId]));
+
+		for (uint32_t slot = 0; slot < NROF_VALUES; slot++) {
+
+			const uint16_t *cell = m_cells[unitCellId(unitId, slot)];
+
+			for (uint32_t laneId = 0; laneId < LANES_WIDTH; laneId++) {
+
+				const uint16_t single = cell[laneId] & singleMask(cell[laneId]);
+
+				twice[laneId] |= unitPlaced[laneId] & single;
+				unitPlaced[laneId] |= single;
+			}
+		}
+
+		for (uint32_t laneId = 0; laneId < LANES_WIDTH; laneId++) {
+			m_conflict[laneId] |= twice[laneId];
+		}
+	}
+
+	for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+
+			uint16_t *cell = m_cells[rowId * NROF_COLS + colId];
+
+			const uint16_t *rowPlaced = placed[rowId];
+			const uint16_t *colPlaced = placed[NROF_ROWS + colId];
+			const uint16_t *boxPlaced = placed[NROF_ROWS + NROF_COLS + (rowId / (NROF_ROWS / NROF_BANDS)) * NROF_STACKS + colId / (NROF_COLS / NROF_STACKS)];
+
+			for (uint32_t laneId = 0; laneId < LANES_WIDTH; laneId++) {
+
+				// Assigned cells keep their value, which is also within the masks of their units
+				const uint16_t remove = (rowPlaced[laneId] | colPlaced[laneId] | boxPlaced[laneId]) & ~singleMask(cell[laneId]);
+				const uint16_t next = cell[laneId] & ~remove;
+
+				changed[laneId] |= cell[laneId] ^ next;
+				m_conflict[laneId] |= ~anyMask(next);
+				cell[laneId] = next;
+			}
+		}
+	}
+}
+
+/**
+ * Assigns the values that are a candidate of only one cell within a unit. A value that is neither assigned
+ * nor a candidate of any cell, or a cell that is the only place for two values, is a conflict
+ */
+void CSudokuLanes::hiddenSingles(uint16_t *changed)
+{
+	for (uint32_t unitId = 0; unitId < NROF_UNITS; unitId++) {
+
+		uint16_t once[LANES_WIDTH] = { 0 };
+		uint16_t twice[LANES_WIDTH] = { 0 };
+		uint16_t assigned[LANES_WIDTH] = { 0 };
+
+		for (uint32_t slot = 0; slot < NROF_VALUES; slot++) {
+
+			const uint16_t *cell = m_cells[unitCellId(unitId, slot)];
+
+			for (uint32_t laneId = 0; laneId < LANES_WIDTH; laneId++) {
+
+				const uint16_t single = singleMask(cell[laneId]);
+				const uint16_t open = cell[laneId] & ~single;
+
+				twice[laneId] |= once[laneId] & open;
+				once[laneId] |= open;
+				assigned[laneId] |= cell[laneId] & single;
+			}
+		}
+
+		uint16_t hidden[LANES_WIDTH];
+
+		for (uint32_t laneId = 0; laneId < LANES_WIDTH; laneId++) {
+
+			hidden[laneId] = once[laneId] & ~twice[laneId] & ~assigned[laneId];
+			m_conflict[laneId] |= ALL_CANDIDATES & ~(once[laneId] | assigned[laneId]);
+		}
+
+		for (uint32_t slot = 0; slot < NROF_VALUES; slot++) {
+
+			uint16_t *cell = m_cells[unitCellId(unitId, slot)];
+
+			for (uint32_t laneId = 0; laneId < LANES_WIDTH; laneId++) {
+
+				const uint16_t found = cell[laneId] & hidden[laneId] & ~singleMask(cell[laneId]);
+				const uint16_t next = cell[laneId] ^ ((cell[laneId] ^ found) & anyMask(found));
+
+				changed[laneId] |= cell[laneId] ^ next;
+				m_conflict[laneId] |= ~singleMask(found);
+				cell[laneId] = next;
+			}
+		}
+	}
+}
+
+/**
+ * Result of the propagation of a lane: VALID_SOLVED, NOT_VALID when it found a conflict, VALID_NOT_SOLVED
+ * when it stalled
+ */
+int CSudokuLanes::getState(const uint32_t laneId) const
+{
+	assert(laneId < LANES_WIDTH);
+
+	if (m_conflict[laneId]) {
+		return NOT_VALID;
+	}
+
+	for (uint32_t cellId = 0; cellId < (NROF_ROWS * NROF_COLS); cellId++) {
+
+		if (1 != bitCount(m_cells[cellId][laneId])) {
+			return VALID_NOT_SOLVED;
+		}
+	}
+
+	return VALID_SOLVED;
+}
+
+/**
+ * Candidates of every cell of a lane, in the layout of CSudokuGrid
+ */
+void CSudokuLanes::getCandidates(const uint32_t laneId, uint16_t cells[NROF_ROWS][NROF_COLS]) const
+{
+	assert(laneId < LANES_WIDTH);
+
+	for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+			cells[rowId][colId] = m_cells[rowId * NROF_COLS + colId][laneId];
+		}
+	}
+}
+
+/**
+ * Writes a lane as a single line of 81 characters (no end of line), '.' for the cells not assigned
+ */
+void CSudokuLanes::writeLine(const uint32_t laneId, char *line) const
+{
+	assert(laneId < LANES_WIDTH);
+	assert(line);
+
+	for (uint32_t cellId = 0; cellId < (NROF_ROWS * NROF_COLS); cellId++) {
+
+		const uint16_t cell = m_cells[cellId][laneId];
+		line[cellId] = (1 == bitCount(cell)) ? bitToVal(cell) : 46; // '.' = 46
+	}
+}
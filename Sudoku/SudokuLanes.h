@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+#include "SudokuGrid.h"
+
+
+// Puzzles advanced together, one per lane. 16 lanes of 16 bits fill an AVX2 register
+#define LANES_WIDTH (16)
+
+
+/**
+ * Solves up to LANES_WIDTH puzzles in lockstep with the naked and hidden singles of all the units.
+ *
+ * The candidates are kept as a structure of arrays: every cell holds the masks of all the lanes next to
+ * each other, so each step of the propagation is a loop over the lanes that the compiler turns into SIMD
+ * instructions (SSE2 by default, AVX2 with SUDOKU_NATIVE). Every round analyses all the units of all the
+ * lanes and the rounds go on while any lane without conflicts makes progress.
+ *
+ * The lanes left unsolved by the propagation are meant to be finished one by one by CSudokuGrid, starting
+ * from their candidates (see getCandidates and CSudokuGrid::readCandidates).
+ */
+class CSudokuLanes
+{
+public:
+	CSudokuLanes();
+	~CSudokuLanes();
+
+	void load(const uint32_t laneId, const char *line);
+	uint32_t propagate();
+
+	int getState(const uint32_t laneId) const;
+	void getCandidates(const uint32_t laneId, uint16_t cells[NROF_ROWS][NROF_COLS]) const;
+	void writeLine(const uint32_t laneId, char *line) const;
+
+private:
+	// Candidates of each cell (row after row) for each lane
+	uint16_t m_cells[NROF_ROWS * NROF_COLS][LANES_WIDTH];
+
+	// Not 0 for the lanes where a cell ran out of candidates or a unit cannot hold all the values
+	uint16_t m_conflict[LANES_WIDTH];
+
+private:
+	void nakedSingles(uint16_t *changed);
+	void hiddenSingles(uint16_t *changed);
+};
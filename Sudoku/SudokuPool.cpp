@@ -0,0 +1,192 @@
+#include "SudokuPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+CSudokuPool::CSudokuPool(const uint32_t nrofThreads)
+	: m_nrofThreads(std::max<uint32_t>(1, nrofThreads)), m_workers(m_nrofThreads), m_generation(0), m_nrofBusy(0), m_running(false), m_stop(false)
+{
+	// The calling thread is the first worker
+	for (uint32_t workerId = 1; workerId < m_nrofThreads; workerId++) {
+		m_threads.push_back(std::thread(&CSudokuPool::loop, this, workerId));
+	}
+}
+
+CSudokuPool::~CSudokuPool()
+{
+	if (m_running) {
+		wait();
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		m_stop = true;
+	}
+
+	m_wake.notify_all();
+
+	for (std::vector<std::thread>::iterator it = m_threads.begin(); it != m_threads.end(); ++it) {
+		it->join();
+	}
+}
+
+/**
+ * Number of workers used by the pool
+ */
+uint32_t CSudokuPool::getNrofThreads() const
+{
+	return m_nrofThreads;
+}
+
+/**
+ * Number of threads the machine can run in parallel
+ */
+uint32_t CSudokuPool::hardwareThreads()
+{
+	return std::max<uint32_t>(1, std::thread::hardware_concurrency());
+}
+
+/**
+ * Runs tasks 0 to 'nrofTasks' - 1 and returns once all of them are done. Tasks are dealt in
+ * chunks of 'grain' consecutive tasks
+ */
+void CSudokuPool::run(const uint32_t nrofTasks, const task_t &task, const uint32_t grain)
+{
+	start(nrofTasks, task, grain);
+	wait();
+}
+
+/**
+ * Same as above, returning at once: the other threads start on the tasks, the calling thread joins them
+ * in wait(), which must be called before the next set of tasks is started
+ */
+void CSudokuPool::start(const uint32_t nrofTasks, const task_t &task, const uint32_t grain)
+{
+	assert(grain > 0);
+	assert(false == m_running);
+
+	uint32_t workerId = 0;
+
+	for (uint32_t first = 0; first < nrofTasks; first += grain) {
+
+		const chunk_t chunk = { first, std::min(nrofTasks, first + grain) };
+
+		std::lock_guard<std::mutex> guard(m_workers[workerId].lock);
+
+		m_workers[workerId].chunks.push_back(chunk);
+		workerId = (workerId + 1) % m_nrofThreads;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+
+		m_task = task;
+		m_generation++;
+		m_nrofBusy = m_nrofThreads - 1;
+	}
+
+	m_running = true;
+	m_wake.notify_all();
+}
+
+/**
+ * Runs the tasks left as the first worker and returns once all the threads are done with theirs
+ */
+void CSudokuPool::wait()
+{
+	assert(m_running);
+
+	work(0, m_task);
+
+	std::unique_lock<std::mutex> lock(m_lock);
+	m_done.wait(lock, [this]() { return (0 == m_nrofBusy); });
+
+	m_running = false;
+}
+
+/**
+ * Thread of a worker, waits for every set of tasks until the pool is destroyed
+ */
+void CSudokuPool::loop(const uint32_t workerId)
+{
+	uint64_t generation = 0;
+
+	for (;;) {
+
+		{
+			std::unique_lock<std::mutex> lock(m_lock);
+			m_wake.wait(lock, [this, generation]() { return m_stop || (generation != m_generation); });
+
+			if (m_stop) {
+				return;
+			}
+
+			generation = m_generation;
+		}
+
+		work(workerId, m_task);
+
+		std::lock_guard<std::mutex> guard(m_lock);
+
+		if (0 == --m_nrofBusy) {
+			m_done.notify_all();
+		}
+	}
+}
+
+/**
+ * Main loop of a worker, runs its own chunks first and then the ones stolen from the rest
+ */
+void CSudokuPool::work(const uint32_t workerId, const task_t &task)
+{
+	chunk_t chunk;
+
+	while (pop(workerId, chunk) || steal(workerId, chunk)) {
+
+		for (uint32_t taskId = chunk.first; taskId < chunk.last; taskId++) {
+			task(workerId, taskId);
+		}
+	}
+}
+
+/**
+ * Takes the last chunk of the worker's own deque
+ */
+bool CSudokuPool::pop(const uint32_t workerId, chunk_t &chunk)
+{
+	worker_t &worker = m_workers[workerId];
+	std::lock_guard<std::mutex> guard(worker.lock);
+
+	if (worker.chunks.empty()) {
+		return false;
+	}
+
+	chunk = worker.chunks.back();
+	worker.chunks.pop_back();
+
+	return true;
+}
+
+/**
+ * Takes the first chunk of the deque of another worker, starting with the next one
+ */
+bool CSudokuPool::steal(const uint32_t workerId, chunk_t &chunk)
+{
+	for (uint32_t id = 1; id < m_nrofThreads; id++) {
+
+		worker_t &victim = m_workers[(workerId + id) % m_nrofThreads];
+		std::lock_guard<std::mutex> guard(victim.lock);
+
+		if (false == victim.chunks.empty()) {
+
+			chunk = victim.chunks.front();
+			victim.chunks.pop_front();
+
+			return true;
+		}
+	}
+
+	return false;
+}
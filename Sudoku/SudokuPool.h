@@ -0,0 +1,74 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Most threads a pool can be asked for, far beyond the cores of any machine it runs on
+#define POOL_MAX_THREADS (1024)
+
+
+/**
+ * Runs a set of tasks over several threads with work stealing.
+ *
+ * Tasks are split in chunks that are dealt to the deques of the workers. Every worker takes chunks
+ * from the back of its own deque and, once it is empty, steals from the front of the others, so a
+ * few long tasks do not leave the rest of the workers idle.
+ *
+ * The threads are started once by the constructor and wait for the next set of tasks in between, the
+ * calling thread being the first worker. A set of tasks can also be started in the background (see
+ * start) while the calling thread prepares the next one, and joined later on (see wait).
+ */
+class CSudokuPool
+{
+public:
+	// Task to be run: worker running it and task number
+	typedef std::function<void(const uint32_t workerId, const uint32_t taskId)> task_t;
+
+	CSudokuPool(const uint32_t nrofThreads);
+	~CSudokuPool();
+
+	uint32_t getNrofThreads() const;
+
+	void run(const uint32_t nrofTasks, const task_t &task, const uint32_t grain = 1);
+	void start(const uint32_t nrofTasks, const task_t &task, const uint32_t grain = 1);
+	void wait();
+
+	static uint32_t hardwareThreads();
+
+private:
+	typedef struct { uint32_t first; uint32_t last; } chunk_t;
+
+	typedef struct {
+		std::mutex lock;
+		std::deque<chunk_t> chunks;
+	} worker_t;
+
+	uint32_t m_nrofThreads;
+	std::vector<worker_t> m_workers;
+
+	// Threads of the workers but the first one, woken up for every set of tasks
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_lock;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+
+	// Tasks being run, number of the set of tasks, threads still running it and whether they must exit
+	task_t m_task;
+	uint64_t m_generation;
+	uint32_t m_nrofBusy;
+	bool m_running;
+	bool m_stop;
+
+private:
+	void loop(const uint32_t workerId);
+	void work(const uint32_t workerId, const task_t &task);
+	bool pop(const uint32_t workerId, chunk_t &chunk);
+	bool steal(const uint32_t workerId, chunk_t &chunk);
+};
@@ -0,0 +1,282 @@
+#include "SudokuRater.h"
+#include "SudokuArchive.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+// Names of the techniques, as printed
+static const char *TECH_NAME[NROF_TECHNIQUES] = {
+	"naked single",
+	"hidden single",
+	"intersection",
+	"naked pair",
+	"hidden pair",
+	"naked triple",
+	"hidden triple",
+	"x-wing",
+	"naked quad",
+	"hidden quad",
+	"swordfish",
+	"search"
+};
+
+CSudokuRater::CSudokuRater()
+{
+}
+
+CSudokuRater::~CSudokuRater()
+{
+}
+
+/**
+ * Rates the puzzle of the grid, which is left solved. Returns the result of solving it
+ */
+int CSudokuRater::rate(CSudokuGrid &grid, rating_t &rating) const
+{
+	rating = rating_t();
+
+	while ((false == grid.hasConflict()) && (false == grid.isSolved())) {
+
+		uint32_t technique;
+
+		if (nakedSingles(grid)) {
+			technique = TECH_NAKED_SINGLE;
+		}
+		else if (hiddenSingles(grid)) {
+			technique = TECH_HIDDEN_SINGLE;
+		}
+		else if (intersections(grid)) {
+			technique = TECH_INTERSECTION;
+		}
+		else if (subsets(grid, 2, true)) {
+			technique = TECH_NAKED_PAIR;
+		}
+		else if (subsets(grid, 2, false)) {
+			technique = TECH_HIDDEN_PAIR;
+		}
+		else if (subsets(grid, 3, true)) {
+			technique = TECH_NAKED_TRIPLE;
+		}
+		else if (subsets(grid, 3, false)) {
+			technique = TECH_HIDDEN_TRIPLE;
+		}
+		else if (fish(grid, 2)) {
+			technique = TECH_XWING;
+		}
+		else if (subsets(grid, 4, true)) {
+			technique = TECH_NAKED_QUAD;
+		}
+		else if (subsets(grid, 4, false)) {
+			technique = TECH_HIDDEN_QUAD;
+		}
+		else if (fish(grid, 3)) {
+			technique = TECH_SWORDFISH;
+		}
+		else {
+			break;
+		}
+
+		rating.steps[technique]++;
+	}
+
+	int retVal = VALID_SOLVED;
+
+	if (grid.hasConflict()) {
+		retVal = NOT_VALID;
+	}
+	else if (false == grid.isSolved()) {
+
+		searchStats_t stats = searchStats_t();
+
+		retVal = grid.search(stats, false);
+		rating.steps[TECH_SEARCH] = stats.branches;
+	}
+
+	for (uint32_t technique = 0; technique < NROF_TECHNIQUES; technique++) {
+
+		if (rating.steps[technique]) {
+			rating.hardest = technique;
+		}
+
+		rating.score += TECH_WEIGHT[technique] * rating.steps[technique];
+	}
+
+	return retVal;
+}
+
+/**
+ * Rates all the puzzles of a file ('-' or empty name for the standard input), one 81 characters line
+ * per puzzle, writing the rating of each one to the standard output
+ */
+int CSudokuRater::run(const std::string &fileName) const
+{
+	if (fileName.empty() || ("-" == fileName)) {
+		return run(std::cin, std::cout);
+	}
+
+	std::ifstream file(fileName, std::ios::binary);
+
+	if (false == file.is_open()) {
+
+		std::cerr << "Unable to open file " << fileName << std::endl;
+		return 1;
+	}
+
+	return run(file, std::cout);
+}
+
+/**
+ * Writes for each puzzle a line with the puzzle, its score, the hardest technique needed and the steps of
+ * each technique. How many puzzles needed each technique is printed on stderr once the stream is over
+ */
+int CSudokuRater::run(std::istream &in, std::ostream &out) const
+{
+	CSudokuGrid grid;
+	std::string line;
+
+	uint64_t nrofPuzzles = 0;
+	uint64_t nrofHardest[NROF_TECHNIQUES] = { 0 };
+	uint64_t totalScore = 0;
+	bool first = true;
+
+	while (std::getline(in, line)) {
+
+		// Archives are not decoded here, they have to be turned into text first
+		if (first && CSudokuArchive::isArchive((const uint8_t *)line.data(), line.size())) {
+
+			std::cerr << "Archives cannot be rated, convert them with --to-text first" << std::endl;
+			return 1;
+		}
+
+		first = false;
+
+		if (line.size() && ('\r' == line.back())) {
+			line.pop_back();
+		}
+
+		if (line.empty()) {
+			continue;
+		}
+
+		rating_t rating;
+
+		if ((false == grid.readLine(line.data(), line.size())) || (NOT_VALID == rate(grid, rating))) {
+
+			out << line << " invalid" << std::endl;
+			continue;
+		}
+
+		out << line.substr(0, NROF_ROWS * NROF_COLS) << " " << rating.score << " " << TECH_NAME[rating.hardest];
+
+		for (uint32_t technique = 0; technique < NROF_TECHNIQUES; technique++) {
+			out << " " << rating.steps[technique];
+		}
+
+		out << "\n";
+
+		nrofPuzzles++;
+		nrofHardest[rating.hardest]++;
+		totalScore += rating.score;
+	}
+
+	out << std::flush;
+
+	std::cerr << std::fixed << std::setprecision(1)
+		<< "Rated " << nrofPuzzles << " puzzles, mean score " << (nrofPuzzles ? (double)totalScore / nrofPuzzles : 0) << std::endl;
+
+	for (uint32_t technique = 0; technique < NROF_TECHNIQUES; technique++) {
+		std::cerr << "\t" << TECH_NAME[technique] << ": " << nrofHardest[technique] << std::endl;
+	}
+
+	return 0;
+}
+
+/**
+ * Name of a technique
+ */
+const char *CSudokuRater::techniqueName(const uint32_t technique)
+{
+	assert(technique < NROF_TECHNIQUES);
+
+	return TECH_NAME[technique];
+}
+
+/**
+ * Removes the assigned values from the rest of their rows, columns and boxes. Cells left with a single
+ * candidate become assigned
+ */
+uint32_t CSudokuRater::nakedSingles(CSudokuGrid &grid) const
+{
+	uint32_t result = grid.checkRows() + grid.checkColumns();
+
+	for (uint16_t bandId = 0; bandId < NROF_BANDS; bandId++) {
+
+		for (uint16_t stackId = 0; stackId < NROF_STACKS; stackId++) {
+			result += grid.checkBox(bandId, stackId);
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Assigns the values that only have one possible cell within a row, a column or a box
+ */
+uint32_t CSudokuRater::hiddenSingles(CSudokuGrid &grid) const
+{
+	uint32_t result = 0;
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+		result += grid.hiddenSingleRow(rowId);
+	}
+
+	for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+		result += grid.hiddenSingleColumn(colId);
+	}
+
+	for (uint16_t bandId = 0; bandId < NROF_BANDS; bandId++) {
+
+		for (uint16_t stackId = 0; stackId < NROF_STACKS; stackId++) {
+			result += grid.hiddenSingleBox(bandId, stackId);
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Removes the candidates of a box confined to one of its rows or columns from the rest of that row or column
+ */
+uint32_t CSudokuRater::intersections(CSudokuGrid &grid) const
+{
+	return grid.checkBands() + grid.checkStacks();
+}
+
+/**
+ * Removes the candidates excluded by the naked (or hidden) subsets of 'size' cells of every unit. Stops
+ * at the first unit where a subset removes any
+ */
+uint32_t CSudokuRater::subsets(CSudokuGrid &grid, const uint32_t size, const bool naked) const
+{
+	uint32_t result = 0;
+
+	for (uint32_t unitId = 0; (0 == result) && (unitId < NROF_UNITS); unitId++) {
+		result = naked ? grid.nakedSubset(unitId, size) : grid.hiddenSubset(unitId, size);
+	}
+
+	return result;
+}
+
+/**
+ * Removes the candidates excluded by the fish of 'size' rows (X-Wing for 2, Swordfish for 3), or if
+ * there is none, by the fish of 'size' columns
+ */
+uint32_t CSudokuRater::fish(CSudokuGrid &grid, const uint32_t size) const
+{
+	const uint32_t result = grid.fish(size, true);
+
+	return result ? result : grid.fish(size, false);
+}
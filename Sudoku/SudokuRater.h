@@ -0,0 +1,66 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+
+#include "SudokuGrid.h"
+
+
+// Techniques used by the rater, from the simplest to the hardest
+enum {
+	TECH_NAKED_SINGLE = 0,
+	TECH_HIDDEN_SINGLE,
+	TECH_INTERSECTION,
+	TECH_NAKED_PAIR,
+	TECH_HIDDEN_PAIR,
+	TECH_NAKED_TRIPLE,
+	TECH_HIDDEN_TRIPLE,
+	TECH_XWING,
+	TECH_NAKED_QUAD,
+	TECH_HIDDEN_QUAD,
+	TECH_SWORDFISH,
+	TECH_SEARCH,
+	NROF_TECHNIQUES
+};
+
+// Score of every step done with each technique. A step of the search is a branch
+const uint32_t TECH_WEIGHT[NROF_TECHNIQUES] = { 1, 3, 10, 20, 25, 30, 40, 45, 50, 60, 70, 100 };
+
+// Outcome of rating a puzzle: steps done with each technique, hardest technique needed and score
+typedef struct {
+	uint32_t steps[NROF_TECHNIQUES];
+	uint32_t hardest;
+	uint32_t score;
+} rating_t;
+
+
+/**
+ * Rates the difficulty of puzzles by solving them as a person would: every step uses the simplest
+ * technique that makes progress (naked singles, then hidden singles, intersections, naked and hidden
+ * subsets from pairs to quads, X-Wing and Swordfish) and only when none of them does, the rest of the
+ * puzzle is searched.
+ *
+ * The techniques are the ones of CSudokuGrid applied to the whole grid, so rating a puzzle costs
+ * about the same as solving it. The rater keeps no state and can be shared by several threads.
+ */
+class CSudokuRater
+{
+public:
+	CSudokuRater();
+	~CSudokuRater();
+
+	int rate(CSudokuGrid &grid, rating_t &rating) const;
+
+	int run(const std::string &fileName) const;
+	int run(std::istream &in, std::ostream &out) const;
+
+	static const char *techniqueName(const uint32_t technique);
+
+private:
+	uint32_t nakedSingles(CSudokuGrid &grid) const;
+	uint32_t hiddenSingles(CSudokuGrid &grid) const;
+	uint32_t intersections(CSudokuGrid &grid) const;
+	uint32_t subsets(CSudokuGrid &grid, const uint32_t size, const bool naked) const;
+	uint32_t fish(CSudokuGrid &grid, const uint32_t size) const;
+};
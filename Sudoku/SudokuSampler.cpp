@@ -0,0 +1,205 @@
+#include "SudokuSampler.h"
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+using namespace std;
+
+// All the orders of three lines (rows of a band or columns of a stack) or three bands or stacks
+static const uint8_t PERMUTATIONS[6][3] = {
+	{ 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+};
+
+CSudokuSampler::CSudokuSampler(const uint64_t seed)
+	: m_nrofSamples(0), m_binary(false)
+{
+	CSudokuGrid::seedRandom(m_random, seed, 0);
+}
+
+CSudokuSampler::~CSudokuSampler()
+{
+}
+
+/**
+ * Writes a random solved grid as a single line of 81 characters (no end of line)
+ */
+void CSudokuSampler::sample(char *line)
+{
+	assert(line);
+
+	if (0 == m_nrofSamples) {
+		fillBase();
+	}
+
+	m_nrofSamples = (m_nrofSamples + 1) % SAMPLER_BASE_SAMPLES;
+
+	// Relabelling of the values
+	char values[NROF_VALUES] = {};
+
+	for (uint32_t valId = 0; valId < NROF_VALUES; valId++) {
+
+		const uint32_t other = draw(valId + 1);
+
+		values[valId] = values[other];
+		values[other] = (char)(49 + valId); // '1' = 49
+	}
+
+	uint8_t rows[NROF_ROWS];
+	uint8_t cols[NROF_COLS];
+
+	shuffleLines(rows);
+	shuffleLines(cols);
+
+	if (draw(2)) {
+
+		for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+			for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+				line[rowId * NROF_COLS + colId] = values[m_base[cols[colId] * NROF_COLS + rows[rowId]]];
+			}
+		}
+	}
+	else {
+
+		for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+			const uint8_t *row = &m_base[rows[rowId] * NROF_COLS];
+
+			for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+				line[rowId * NROF_COLS + colId] = values[row[cols[colId]]];
+			}
+		}
+	}
+}
+
+/**
+ * Samples 'nrofGrids' grids into a file ('-' or empty name for the standard output)
+ */
+int CSudokuSampler::run(const uint64_t nrofGrids, const std::string &fileName)
+{
+	if (fileName.empty() || ("-" == fileName)) {
+		return run(nrofGrids, stdout);
+	}
+
+	FILE *out = fopen(fileName.c_str(), "wb");
+
+	if (nullptr == out) {
+
+		std::cerr << "Unable to open file " << fileName << std::endl;
+		return 1;
+	}
+
+	const int retVal = run(nrofGrids, out);
+	fclose(out);
+
+	return retVal;
+}
+
+/**
+ * Samples the grids into a buffer written in big blocks, printing the throughput on stderr at the end
+ */
+int CSudokuSampler::run(const uint64_t nrofGrids, FILE *out)
+{
+	assert(out);
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	const size_t lineSize = NROF_ROWS * NROF_COLS + 1;
+	std::vector<char> buffer(SAMPLER_BUFFER_SIZE - SAMPLER_BUFFER_SIZE % lineSize);
+	size_t used = 0;
+	bool success = true;
+
+	if (m_binary) {
+
+		CSudokuArchive archive;
+		success = archive.create(out, ARCHIVE_SOLUTIONS);
+
+		for (uint64_t gridId = 0; gridId < nrofGrids; gridId++) {
+
+			sample(buffer.data());
+			archive.write(buffer.data());
+		}
+
+		success = archive.close() && success;
+	}
+	else {
+
+		for (uint64_t gridId = 0; gridId < nrofGrids; gridId++) {
+
+			sample(&buffer[used]);
+			buffer[used + lineSize - 1] = '\n';
+			used += lineSize;
+
+			if (used == buffer.size()) {
+
+				fwrite(buffer.data(), 1, used, out);
+				used = 0;
+			}
+		}
+
+		fwrite(buffer.data(), 1, used, out);
+		fflush(out);
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cerr << std::fixed << std::setprecision(1)
+		<< "Sampled " << nrofGrids << " grids in " << seconds << " s: "
+		<< ((seconds > 0) ? nrofGrids / seconds : 0) << " grids/s" << std::endl;
+
+	return success ? 0 : 1;
+}
+
+/**
+ * Writes the grids as a binary archive of solutions (see CSudokuArchive) instead of text
+ */
+void CSudokuSampler::setBinary(const bool binary)
+{
+	m_binary = binary;
+}
+
+/**
+ * Fills a new base grid at random
+ */
+void CSudokuSampler::fillBase()
+{
+	const bool filled = m_grid.fillGrid(m_random);
+	assert(filled);
+	(void)filled;
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+			m_base[rowId * NROF_COLS + colId] = (uint8_t)bitIndex(m_grid.getCandidates(rowId, colId));
+		}
+	}
+}
+
+/**
+ * Random order of the rows (or columns) of a grid that keeps it valid: the bands are shuffled as a
+ * whole and then the rows within each band
+ */
+void CSudokuSampler::shuffleLines(uint8_t *lines)
+{
+	const uint8_t *bands = PERMUTATIONS[draw(6)];
+
+	for (uint32_t bandId = 0; bandId < NROF_BANDS; bandId++) {
+
+		const uint8_t *rows = PERMUTATIONS[draw(6)];
+
+		for (uint32_t rowId = 0; rowId < (NROF_ROWS / NROF_BANDS); rowId++) {
+			lines[bandId * (NROF_ROWS / NROF_BANDS) + rowId] = (uint8_t)(bands[bandId] * (NROF_ROWS / NROF_BANDS) + rows[rowId]);
+		}
+	}
+}
+
+/**
+ * Random number from 0 to 'range' - 1
+ */
+uint32_t CSudokuSampler::draw(const uint32_t range)
+{
+	return (uint32_t)(((uint64_t)m_random() * range) >> 32);
+}
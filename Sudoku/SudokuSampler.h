@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "SudokuArchive.h"
+#include "SudokuGrid.h"
+
+
+// Grids sampled from the same base grid before a new one is searched
+#define SAMPLER_BASE_SAMPLES (4096)
+
+// Size of the blocks written to the output
+#define SAMPLER_BUFFER_SIZE (1 << 20)
+
+
+/**
+ * Samples random solved grids, written in line format (81 characters, see CSudokuGrid::writeLine).
+ *
+ * A base grid is filled at random (CSudokuGrid::fillGrid) and every sample applies to it a random
+ * combination of the transformations that keep a grid valid: relabelling of the digits, permutation
+ * of the bands and of the rows within each band, the same for stacks and columns, and transposition.
+ * The base grid is replaced every SAMPLER_BASE_SAMPLES samples, so the samples are not limited to
+ * the transformations of a single grid.
+ *
+ * The grids can also be written as a binary archive of solutions (see CSudokuArchive).
+ */
+class CSudokuSampler
+{
+public:
+	CSudokuSampler(const uint64_t seed);
+	~CSudokuSampler();
+
+	void sample(char *line);
+
+	int run(const uint64_t nrofGrids, const std::string &fileName);
+	int run(const uint64_t nrofGrids, FILE *out);
+
+	void setBinary(const bool binary);
+
+private:
+	std::mt19937 m_random;
+
+	// Grid used to fill the base grids
+	CSudokuGrid m_grid;
+
+	// Base grid, with values from 0 ('1') to 8 ('9')
+	uint8_t m_base[NROF_ROWS * NROF_COLS];
+
+	// Samples taken from the current base grid
+	uint32_t m_nrofSamples;
+
+	// Whether the grids are written to an archive instead of text
+	bool m_binary;
+
+private:
+	void fillBase();
+	void shuffleLines(uint8_t *lines);
+	uint32_t draw(const uint32_t range);
+};
@@ -0,0 +1,56 @@
+#include "SudokuSamples.h"
+
+const char *const SAMPLE_PUZZLES[NROF_SAMPLE_PUZZLES] = {
+	"51.....838..416..5..........985.461....9.1....642.357..........6..157..478.....96", // easy.txt
+	"7...9...32..468..1..8...6...4..2..9....3.4....8..1..3...9...7..5..142..68...5...2", // medium.txt
+	".523..6..6...4...3............63..1.47.....35.2..58............1...9...6..5..172.", // hard.txt
+	"5.....1.7..43..5.....2...8..9.4.2...4.......6...1.3.5..8...4.....2..67..3.9.....1"  // samurai.txt
+};
+
+const char *const HARD_PUZZLES[NROF_HARD_PUZZLES] = {
+	"1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1", // Easter Monster
+	".......39.....1..5..3.5.8....8.9...6.7...2...1..4.......9.8..5..2....6..4..7.....", // Golden Nugget
+	"1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..", // AI Escargot
+	"8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..", // Arto Inkala 2012
+	"4.....8.5.3..........7......2.....6.....8.4......1.......6.3.7.5..2.....1.4......", // top95 #1
+	"52...6.........7.13...........4..8..6......5...........418.........3..2...87.....", // top95 #2
+	"6.....8.3.4.7.................5.4.7.3..2.....1.6.......2.....5.....8.6......1....", // top95 #3
+	"48.3............71.2.......7.5....6....2..8.............1.76...3.....4......5....", // top95 #4
+	"....14....3....2...7..........9...3.6.1.............8.2.....1.4....5.6.....7.8...", // top95 #5
+	"......52..8.4......3...9...5.1...6..2..7........3.....6...1..........7.4.......3.", // top95 #6
+	"6.2.5.........3.4..........43...8....1....2........7..5..27...........81...6.....", // top95 #7
+	".524.........7.1..............8.2...3.....6...9.5.....1.6.3...........897........", // top95 #8
+	"6.2.5.........4.3..........43...8....1....2........7..5..27...........81...6.....", // top95 #9
+	".923.........8.1...........1.7.4...........658.........6.5.2...4.....7.....9.....", // top95 #10
+	"...8.1..........435............7.8........1...2..3....6......75..34........2..6..", // 17 clues
+	".......12.5.4............3.7..6..4....1..........8....92....8.....51.7.......3..."  // 17 clues
+};
+
+const char *const BOARD16_PUZZLES[NROF_BOARD16_PUZZLES] = {
+	"2749FA......68E.C..51...GB.A2..76.8..C..4..2A.BF...B....8E...D537.546.G.B..319.2.A...189.G.F...C..9....B5...F...F6E..7..982...D.9..1GB.A.7.5E6.8.8....7.2149BA.G5.C.8.....GB..1....3.....F....7.G......7..98D3...916..C.72....AED..C......EG4.2..5.2..A.3C.D.1.9",
+	"C9D..7B.4...A...B..E9DCF..3..46.GA83..6...F.2.....45.8G372.B9.C.A.B.F...G.8...24....5.2..F.1.BA..5...G.8.E7.....1..D..A.654...9......9FG..B3..5.3...D1.C.8.F4.E6.8.G42E61DC...3...1....B24.....G....B3...6.7.FD9..E..FD..BA8C5..8B.A.5.1.G.D6....G.9.E...C..B...",
+	"B.F.....76...3...7.8A.9.....D...G.1E.68.C.9..BF......B5...E.7..8..G...C89.......A...3F295......7.93..1..E47G.A6.15.D....8..6...2.G..C.......BED1.6CA.5F3BE..G.74.B..784G.9A.35.F.3....1..8476.CA2..3.D.F......8..1EG8.64.2..FD...F5.E..14C.8A.93.4...2..FDB51..."
+};
+
+const char *const SAMURAI_PUZZLE =
+	"..7......   .....6.8."
+	"..6...89.   7....249."
+	"5.9..6.71   ..4.3...."
+	"8...12..4   3.5.4.9.."
+	"7.43.....   4....1..."
+	"........2   ....9.87."
+	"....6....3..........."
+	".6.9......86...6..12."
+	"....5...9..2......5.9"
+	"      ........1      "
+	"      ..2...5..      "
+	"      5........      "
+	"1.5......6..7...2...."
+	".37..2...95......8.5."
+	"...........3....3...."
+	".71.5....   4........"
+	"...8....5   .....56.3"
+	"..8.2.4.1   6..17...4"
+	"....6.8..   36.8..9.1"
+	".831....7   .89...4.."
+	".6.7.....   ......5..";
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "SudokuGrid.h"
+
+
+// Puzzles of the Debug folder, well known hard puzzles and 16x16 boards built into the program
+#define NROF_SAMPLE_PUZZLES (4)
+#define NROF_HARD_PUZZLES (16)
+#define NROF_BOARD16_PUZZLES (3)
+
+// Sample puzzles of the Debug folder, in line format
+extern const char *const SAMPLE_PUZZLES[NROF_SAMPLE_PUZZLES];
+
+// Well known hard puzzles, all of them with a single solution
+extern const char *const HARD_PUZZLES[NROF_HARD_PUZZLES];
+
+// Random 16x16 boards with 45% of clues, all of them with a single solution
+extern const char *const BOARD16_PUZZLES[NROF_BOARD16_PUZZLES];
+
+// Samurai puzzle with a single solution, the 21 rows of its layout one after the other
+extern const char *const SAMURAI_PUZZLE;
@@ -0,0 +1,380 @@
+#include "SudokuSamurai.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// Top left corner of each grid within the layout: the corner grids and then the centre one
+static const uint32_t GRID_ORIGINS[SAMURAI_GRIDS][2] = {
+	{ 0, 0 }, { 0, 12 }, { 12, 0 }, { 12, 12 }, { 6, 6 }
+};
+
+// Geometry of the puzzle, built once
+typedef struct {
+	// Cell at each position of the layout, -1 outside the grids
+	int16_t layout[SAMURAI_SIZE][SAMURAI_SIZE];
+
+	// Units of the cells and their intersections
+	engineTables_t<samuraiGeometry_t> units;
+} samuraiTables_t;
+
+/**
+ * Numbers the cells of the layout row after row, and the units grid after grid (rows, columns and then
+ * boxes, skipping the boxes already numbered by a previous grid)
+ */
+static samuraiTables_t buildTables()
+{
+	samuraiTables_t tables;
+
+	tables.units.clear();
+
+	for (uint32_t row = 0; row < SAMURAI_SIZE; row++) {
+
+		for (uint32_t col = 0; col < SAMURAI_SIZE; col++) {
+			tables.layout[row][col] = -1;
+		}
+	}
+
+	int16_t nrofCells = 0;
+
+	for (uint32_t row = 0; row < SAMURAI_SIZE; row++) {
+
+		for (uint32_t col = 0; col < SAMURAI_SIZE; col++) {
+
+			for (uint32_t gridId = 0; gridId < SAMURAI_GRIDS; gridId++) {
+
+				if ((row - GRID_ORIGINS[gridId][0] < NROF_ROWS) && (col - GRID_ORIGINS[gridId][1] < NROF_COLS)) {
+
+					tables.layout[row][col] = nrofCells++;
+					break;
+				}
+			}
+		}
+	}
+
+	assert(SAMURAI_CELLS == nrofCells);
+
+	// Unit of each box of the layout (7 x 7 boxes), -1 until a grid numbers it
+	int16_t boxUnits[SAMURAI_SIZE / NROF_BANDS][SAMURAI_SIZE / NROF_STACKS];
+	memset(boxUnits, -1, sizeof(boxUnits));
+
+	// Units of every row, column and box of each grid
+	uint16_t gridUnits[SAMURAI_GRIDS][NROF_UNITS];
+	uint16_t nrofUnits = 0;
+
+	for (uint32_t gridId = 0; gridId < SAMURAI_GRIDS; gridId++) {
+
+		const uint32_t top = GRID_ORIGINS[gridId][0];
+		const uint32_t left = GRID_ORIGINS[gridId][1];
+
+		for (uint32_t unitId = 0; unitId < NROF_UNITS; unitId++) {
+
+			if (unitId >= (NROF_ROWS + NROF_COLS)) {
+
+				const uint32_t boxId = unitId - NROF_ROWS - NROF_COLS;
+				int16_t &boxUnit = boxUnits[top / NROF_BANDS + boxId / NROF_STACKS][left / NROF_STACKS + boxId % NROF_STACKS];
+
+				if (boxUnit >= 0) {
+
+					gridUnits[gridId][unitId] = (uint16_t)boxUnit;
+					continue;
+				}
+
+				boxUnit = (int16_t)nrofUnits;
+			}
+
+			for (uint32_t slot = 0; slot < NROF_VALUES; slot++) {
+
+				uint32_t rowId, colId;
+
+				if (unitId < NROF_ROWS) {
+
+					rowId = unitId;
+					colId = slot;
+				}
+				else if (unitId < (NROF_ROWS + NROF_COLS)) {
+
+					rowId = slot;
+					colId = unitId - NROF_ROWS;
+				}
+				else {
+
+					const uint32_t boxId = unitId - NROF_ROWS - NROF_COLS;
+
+					rowId = (boxId / NROF_STACKS) * NROF_BANDS + slot / NROF_STACKS;
+					colId = (boxId % NROF_STACKS) * NROF_STACKS + slot % NROF_STACKS;
+				}
+
+				const uint16_t cellId = (uint16_t)tables.layout[top + rowId][left + colId];
+
+				tables.units.addCell(nrofUnits, slot, cellId);
+			}
+
+			gridUnits[gridId][unitId] = nrofUnits++;
+		}
+	}
+
+	assert(SAMURAI_UNITS == nrofUnits);
+
+	// Every box crosses three rows and three columns of each of its grids
+	for (uint32_t gridId = 0; gridId < SAMURAI_GRIDS; gridId++) {
+
+		for (uint32_t boxId = 0; boxId < (NROF_BANDS * NROF_STACKS); boxId++) {
+
+			const uint16_t boxUnit = gridUnits[gridId][NROF_ROWS + NROF_COLS + boxId];
+
+			for (uint32_t lineId = 0; lineId < NROF_BANDS; lineId++) {
+
+				const uint16_t rowUnit = gridUnits[gridId][(boxId / NROF_STACKS) * NROF_BANDS + lineId];
+				const uint16_t colUnit = gridUnits[gridId][NROF_ROWS + (boxId % NROF_STACKS) * NROF_STACKS + lineId];
+
+				tables.units.addSegment(boxUnit, rowUnit);
+				tables.units.addSegment(rowUnit, boxUnit);
+				tables.units.addSegment(boxUnit, colUnit);
+				tables.units.addSegment(colUnit, boxUnit);
+			}
+		}
+	}
+
+	return tables;
+}
+
+static const samuraiTables_t &tables()
+{
+	static const samuraiTables_t TABLES = buildTables();
+	return TABLES;
+}
+
+const engineTables_t<samuraiGeometry_t> &samuraiGeometry_t::tables()
+{
+	return ::tables().units;
+}
+
+CSudokuSamurai::CSudokuSamurai()
+{
+}
+
+CSudokuSamurai::~CSudokuSamurai()
+{
+}
+
+/**
+ * Reads a Samurai puzzle from a text file of 21 lines of 21 characters (see readLine). Lines can be
+ * shorter when they end outside the grids
+ */
+bool CSudokuSamurai::readGrid(const std::string &fileName)
+{
+	std::ifstream file(fileName);
+
+	if (false == file.is_open()) {
+		return false;
+	}
+
+	std::string layout(SAMURAI_SIZE * SAMURAI_SIZE, 46); // '.' = 46
+	std::string line;
+	uint32_t row = 0;
+
+	while ((row < SAMURAI_SIZE) && getline(file, line)) {
+
+		if (line.size() && ('\r' == line.back())) {
+			line.pop_back();
+		}
+
+		layout.replace(row * SAMURAI_SIZE, std::min<size_t>(line.size(), SAMURAI_SIZE), line, 0, SAMURAI_SIZE);
+		row++;
+	}
+
+	if (row < SAMURAI_SIZE) {
+
+		std::cerr << "Less number of rows than expected: " << row << std::endl;
+		return false;
+	}
+
+	return readLine(layout.data(), layout.size());
+}
+
+/**
+ * Reads a Samurai puzzle from a single line holding the 21 rows of the layout one after the other. Each
+ * character is either a number (1-9) or some other character to symbolize an empty cell
+ */
+bool CSudokuSamurai::readLine(const char *line, const size_t length)
+{
+	assert(line);
+
+	if (length < (SAMURAI_SIZE * SAMURAI_SIZE)) {
+		return false;
+	}
+
+	m_engine.clear();
+
+	for (uint32_t row = 0; row < SAMURAI_SIZE; row++) {
+
+		for (uint32_t col = 0; col < SAMURAI_SIZE; col++) {
+
+			const int16_t cellId = tables().layout[row][col];
+			const char value = line[row * SAMURAI_SIZE + col];
+
+			// '1' = 49, '9' = 57
+			if ((cellId >= 0) && (value >= 49) && (value <= 57)) {
+				m_engine.setCell((uint32_t)cellId, valToBit(value));
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Writes the puzzle as a single line of 21 x 21 characters (no end of line): '.' for the cells not
+ * assigned and blanks outside the grids
+ */
+void CSudokuSamurai::writeLine(char *line) const
+{
+	assert(line);
+
+	for (uint32_t row = 0; row < SAMURAI_SIZE; row++) {
+
+		for (uint32_t col = 0; col < SAMURAI_SIZE; col++) {
+
+			const int16_t cellId = tables().layout[row][col];
+			char value = 32; // ' ' = 32
+
+			if (cellId >= 0) {
+
+				const uint16_t cell = m_engine.getCell((uint32_t)cellId);
+				value = (1 == bitCount(cell)) ? bitToVal(cell) : 46; // '.' = 46
+			}
+
+			line[row * SAMURAI_SIZE + col] = value;
+		}
+	}
+}
+
+/**
+ * Prints the puzzle as 21 lines of 21 characters, without the blanks at the end of the lines
+ */
+void CSudokuSamurai::print(std::ostream &out) const
+{
+	char line[SAMURAI_SIZE * SAMURAI_SIZE];
+	writeLine(line);
+
+	for (uint32_t row = 0; row < SAMURAI_SIZE; row++) {
+
+		std::string text(line + row * SAMURAI_SIZE, SAMURAI_SIZE);
+		text.erase(text.find_last_not_of(' ') + 1);
+
+		out << text << std::endl;
+	}
+}
+
+/**
+ * Solves the puzzle, leaving it solved unless there is no solution
+ */
+int CSudokuSamurai::solve(searchStats_t &stats)
+{
+	return m_engine.solve(stats);
+}
+
+/**
+ * Counts the solutions of the puzzle, stopping as soon as 'limit' of them are found, so a limit of 2
+ * tells whether the solution is unique. The puzzle is left as it was
+ */
+uint32_t CSudokuSamurai::countSolutions(const uint32_t limit)
+{
+	return m_engine.countSolutions(limit);
+}
+
+bool CSudokuSamurai::isSolved() const
+{
+	return m_engine.isSolved();
+}
+
+bool CSudokuSamurai::hasConflict() const
+{
+	return m_engine.hasConflict();
+}
+
+/**
+ * Fills the five grids with a random solution, searching from the empty puzzle with the candidates of
+ * every cell tried in random order
+ */
+bool CSudokuSamurai::fillGrid(std::mt19937 &random)
+{
+	return m_engine.fill(random);
+}
+
+/**
+ * Generates a puzzle with a single solution: fills the grids at random and removes their clues in random
+ * order, in pairs symmetric about the centre of the layout, keeping the ones whose removal leaves more
+ * than one solution. The puzzle is left with the clues only. Returns the number of clues
+ */
+uint32_t CSudokuSamurai::generate(std::mt19937 &random)
+{
+	if (false == fillGrid(random)) {
+		return 0;
+	}
+
+	char puzzle[SAMURAI_SIZE * SAMURAI_SIZE];
+	writeLine(puzzle);
+
+	// Symmetric pairs are taken through the first half of the layout, the centre is its own pair
+	const uint32_t nrofPositions = SAMURAI_SIZE * SAMURAI_SIZE;
+	std::vector<uint16_t> positions;
+
+	for (uint16_t position = 0; position <= (nrofPositions / 2); position++) {
+
+		if (tables().layout[position / SAMURAI_SIZE][position % SAMURAI_SIZE] >= 0) {
+			positions.push_back(position);
+		}
+	}
+
+	// Fisher-Yates, see shuffle in SudokuGrid.cpp
+	for (size_t id = positions.size(); id > 1; id--) {
+
+		const size_t other = (size_t)(((uint64_t)random() * id) >> 32);
+		std::swap(positions[id - 1], positions[other]);
+	}
+
+	uint32_t clues = SAMURAI_CELLS;
+
+	for (std::vector<uint16_t>::iterator it = positions.begin(); it != positions.end(); ++it) {
+
+		const uint16_t position = *it;
+		const uint16_t pair = (uint16_t)(nrofPositions - 1 - position);
+
+		const char value = puzzle[position];
+		const char pairValue = puzzle[pair];
+
+		puzzle[position] = 46; // '.' = 46
+		puzzle[pair] = 46;
+
+		readLine(puzzle, nrofPositions);
+
+		if (1 == countSolutions(2)) {
+			clues -= (position == pair) ? 1 : 2;
+		}
+		else {
+
+			puzzle[position] = value;
+			puzzle[pair] = pairValue;
+		}
+	}
+
+	readLine(puzzle, nrofPositions);
+
+	return clues;
+}
+
+/**
+ * Same as above, generating puzzle 'number' of the sequence of puzzles of 'seed'
+ */
+uint32_t CSudokuSamurai::generate(const uint64_t seed, const uint64_t number)
+{
+	std::mt19937 random;
+	CSudokuGrid::seedRandom(random, seed, number);
+
+	return generate(random);
+}
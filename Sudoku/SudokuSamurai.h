@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SudokuEngine.h"
+#include "SudokuGrid.h"
+
+
+// Grids of a Samurai puzzle: four corner grids and a centre grid that shares a box with each of them
+#define SAMURAI_GRIDS (5)
+#define SAMURAI_SHARED_BOXES (4)
+
+// Rows and columns of the layout holding the five grids
+#define SAMURAI_SIZE (21)
+
+// Cells of the puzzle, the shared boxes counted once
+#define SAMURAI_CELLS (SAMURAI_GRIDS * NROF_ROWS * NROF_COLS - SAMURAI_SHARED_BOXES * NROF_VALUES)
+
+// Rows, columns and boxes of every grid, the shared boxes counted once
+#define SAMURAI_UNITS (SAMURAI_GRIDS * NROF_UNITS - SAMURAI_SHARED_BOXES)
+
+// Most units a cell belongs to: the row and column of both grids sharing its box, and the box
+#define SAMURAI_CELL_UNITS (5)
+
+// Most intersections of a unit with other units: a shared box crosses the 6 rows and columns of each grid
+#define SAMURAI_UNIT_SEGMENTS (4 * NROF_BANDS)
+
+
+/**
+ * Geometry of a Samurai puzzle for CSudokuEngine, the tables are built in SudokuSamurai.cpp
+ */
+struct samuraiGeometry_t {
+
+	static constexpr uint32_t VALUES = NROF_VALUES;
+	static constexpr uint32_t CELLS = SAMURAI_CELLS;
+	static constexpr uint32_t UNITS = SAMURAI_UNITS;
+	static constexpr uint32_t CELL_UNITS = SAMURAI_CELL_UNITS;
+	static constexpr uint32_t SEGMENTS = SAMURAI_UNIT_SEGMENTS;
+	static constexpr uint32_t SHARED = NROF_VALUES / NROF_BANDS;
+
+	static const engineTables_t<samuraiGeometry_t> &tables();
+};
+
+
+/**
+ * Samurai puzzle: five 9x9 grids laid out in a 21x21 square, the centre grid sharing each of its corner
+ * boxes with one of the corner grids.
+ *
+ * The 369 cells are held only once, so a shared cell belongs to the rows and columns of two grids and any
+ * elimination is seen by both of them at once. The puzzle is solved by CSudokuEngine with the tables of
+ * its geometry (see samuraiGeometry_t): only the units around the cells that changed are analysed again,
+ * across the grid boundaries, and a shared box crosses the rows and columns of both its grids.
+ *
+ * Puzzles are read and written as 21 lines of 21 characters ('1'-'9' for a clue, any other character for
+ * an empty cell, anything outside the five grids is ignored), or as the same characters in a single line.
+ */
+class CSudokuSamurai
+{
+public:
+	CSudokuSamurai();
+	~CSudokuSamurai();
+
+	bool readGrid(const std::string &fileName);
+	bool readLine(const char *line, const size_t length);
+	void writeLine(char *line) const;
+	void print(std::ostream &out = std::cout) const;
+
+	int solve(searchStats_t &stats);
+	uint32_t countSolutions(const uint32_t limit = 2);
+
+	bool isSolved() const;
+	bool hasConflict() const;
+
+	bool fillGrid(std::mt19937 &random);
+	uint32_t generate(std::mt19937 &random);
+	uint32_t generate(const uint64_t seed, const uint64_t number);
+
+private:
+	CSudokuEngine<samuraiGeometry_t> m_engine;
+};
@@ -0,0 +1,1186 @@
+#include "SudokuGrid.h"
+#include "SudokuArchive.h"
+#include "SudokuBatch.h"
+#include "SudokuBoard.h"
+#include "SudokuCache.h"
+#include "SudokuCanonical.h"
+#include "SudokuConstraints.h"
+#include "SudokuCorpus.h"
+#include "SudokuGenerator.h"
+#include "SudokuKernels.h"
+#include "SudokuRater.h"
+#include "SudokuSampler.h"
+#include "SudokuSamples.h"
+#include "SudokuSamurai.h"
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Folder of the sample puzzles, given by the build
+#if !defined(SUDOKU_SAMPLES_DIR)
+#define SUDOKU_SAMPLES_DIR "Debug"
+#endif
+
+// Sample puzzles of the Debug folder, in the order of SAMPLE_PUZZLES
+static const char *SAMPLE_FILES[NROF_SAMPLE_PUZZLES] = { "easy.txt", "medium.txt", "hard.txt", "samurai.txt" };
+
+// Failed checks of the test being run
+static uint32_t g_nrofFailures = 0;
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+static void check(const bool condition, const char *text, const char *file, const int line)
+{
+	if (false == condition) {
+
+		std::cerr << file << ":" << line << ": check failed: " << text << std::endl;
+		g_nrofFailures++;
+	}
+}
+
+/**
+ * Whether the cells of a unit of a board in line format hold every value once. 'step' goes from one
+ * cell of the unit to the next one, every 'width' cells the next row of a box starts
+ */
+static bool isUnitValid(const char *line, const uint32_t size, const uint32_t first, const uint32_t step, const uint32_t width, const uint32_t rowStep)
+{
+	std::vector<bool> seen(size, false);
+
+	for (uint32_t id = 0; id < size; id++) {
+
+		const int valId = CSudokuBoard<5>::fromChar(line[first + (id / width) * rowStep + (id % width) * step]);
+
+		if ((valId < 0) || ((uint32_t)valId >= size) || seen[valId]) {
+			return false;
+		}
+
+		seen[valId] = true;
+	}
+
+	return true;
+}
+
+/**
+ * Whether a board of 'box' x 'box' boxes in line format is solved and keeps the clues of its puzzle
+ */
+static bool isSolution(const char *solution, const char *puzzle, const uint32_t box = NROF_BANDS)
+{
+	const uint32_t size = box * box;
+
+	for (uint32_t cellId = 0; cellId < size * size; cellId++) {
+
+		if ((CSudokuBoard<5>::fromChar(puzzle[cellId]) >= 0) && (puzzle[cellId] != solution[cellId])) {
+			return false;
+		}
+	}
+
+	for (uint32_t id = 0; id < size; id++) {
+
+		const uint32_t boxFirst = (id / box) * box * size + (id % box) * box;
+
+		if ((false == isUnitValid(solution, size, id * size, 1, size, 0)) || (false == isUnitValid(solution, size, id, size, size, 0))
+			|| (false == isUnitValid(solution, size, boxFirst, 1, box, size))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Solution of a puzzle in line format, as solved by a grid with the given engine and threads
+ */
+static std::string solveLine(const char *puzzle, const int engine = ENGINE_BACKTRACK, const uint32_t nrofThreads = 1, const uint32_t logic = LOGIC_NONE)
+{
+	CSudokuGrid grid;
+	char solution[NROF_ROWS * NROF_COLS];
+	searchStats_t stats;
+
+	grid.setLogic(logic);
+
+	if ((false == grid.readLine(puzzle, NROF_ROWS * NROF_COLS)) || (VALID_SOLVED != grid.solve(stats, false, engine, nrofThreads))) {
+		return std::string();
+	}
+
+	grid.writeLine(solution);
+
+	return std::string(solution, NROF_ROWS * NROF_COLS);
+}
+
+/**
+ * Applies a random transformation keeping the rules of Sudoku: transposition, bands, rows within each band,
+ * stacks, columns within each stack and relabelling of the values
+ */
+static void shuffleGrid(const char *line, char *transformed, std::mt19937 &random)
+{
+	uint32_t rows[NROF_ROWS];
+	uint32_t cols[NROF_COLS];
+	char labels[NROF_VALUES];
+
+	for (uint32_t *order : { rows, cols }) {
+
+		uint32_t groups[3] = { 0, 1, 2 };
+		std::shuffle(groups, groups + 3, random);
+
+		for (uint32_t groupId = 0; groupId < 3; groupId++) {
+
+			uint32_t lines[3] = { 0, 1, 2 };
+			std::shuffle(lines, lines + 3, random);
+
+			for (uint32_t id = 0; id < 3; id++) {
+				order[groupId * 3 + id] = groups[groupId] * 3 + lines[id];
+			}
+		}
+	}
+
+	for (uint32_t valId = 0; valId < NROF_VALUES; valId++) {
+		labels[valId] = (char)(49 + valId); // '1' = 49
+	}
+
+	std::shuffle(labels, labels + NROF_VALUES, random);
+
+	const bool transposed = (0 != (random() & 1));
+
+	for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint32_t colId = 0; colId < NROF_COLS; colId++) {
+
+			const char value = transposed ? line[cols[colId] * NROF_COLS + rows[rowId]] : line[rows[rowId] * NROF_COLS + cols[colId]];
+
+			// '1' = 49, '9' = 57, '.' = 46
+			transformed[rowId * NROF_COLS + colId] = ((value >= 49) && (value <= 57)) ? labels[value - 49] : 46;
+		}
+	}
+}
+
+/**
+ * Writes text to a temporary file, rewound for reading
+ */
+static FILE *tempFile(const std::string &text)
+{
+	FILE *file = tmpfile();
+
+	if (file) {
+
+		fwrite(text.data(), 1, text.size(), file);
+		rewind(file);
+	}
+
+	return file;
+}
+
+/**
+ * Whole contents of a temporary file
+ */
+static std::string readFile(FILE *file)
+{
+	std::string text;
+	char buffer[4096];
+	size_t nrofBytes;
+
+	rewind(file);
+
+	while (0 < (nrofBytes = fread(buffer, 1, sizeof(buffer), file))) {
+		text.append(buffer, nrofBytes);
+	}
+
+	return text;
+}
+
+/**
+ * The sample puzzles and the hard ones have a single solution, found by every engine
+ */
+static void testSolve()
+{
+	std::vector<const char *> puzzles(SAMPLE_PUZZLES, SAMPLE_PUZZLES + NROF_SAMPLE_PUZZLES);
+	puzzles.insert(puzzles.end(), HARD_PUZZLES, HARD_PUZZLES + NROF_HARD_PUZZLES);
+
+	for (const char *puzzle : puzzles) {
+
+		const std::string solution = solveLine(puzzle);
+
+		CHECK(isSolution(solution.data(), puzzle));
+		CHECK(solution == solveLine(puzzle, ENGINE_DLX));
+		CHECK(solution == solveLine(puzzle, ENGINE_BACKTRACK, 4));
+		CHECK(solution == solveLine(puzzle, ENGINE_BACKTRACK, 1, LOGIC_ALL));
+
+		CSudokuGrid grid;
+		grid.readLine(puzzle, NROF_ROWS * NROF_COLS);
+
+		CHECK(1 == grid.countSolutions(2));
+	}
+
+	// Without its first clues the Easter Monster has many solutions
+	char puzzle[NROF_ROWS * NROF_COLS];
+	memcpy(puzzle, HARD_PUZZLES[0], sizeof(puzzle));
+	memset(puzzle, 46, 18); // '.' = 46
+
+	CSudokuGrid grid;
+	grid.readLine(puzzle, NROF_ROWS * NROF_COLS);
+
+	CHECK(5 == grid.countSolutions(5));
+
+	// Two clues with the same value in a row
+	memcpy(puzzle, HARD_PUZZLES[0], sizeof(puzzle));
+	puzzle[1] = 49; // '1' = 49
+
+	grid.readLine(puzzle, NROF_ROWS * NROF_COLS);
+
+	CHECK(0 == grid.countSolutions(2));
+	CHECK(solveLine(puzzle).empty());
+}
+
+/**
+ * The files of the Debug folder are read as the puzzles built into the program
+ */
+static void testSampleFiles()
+{
+	for (uint32_t sampleId = 0; sampleId < NROF_SAMPLE_PUZZLES; sampleId++) {
+
+		CSudokuGrid grid;
+		char line[NROF_ROWS * NROF_COLS];
+
+		CHECK(grid.readGrid(std::string(SUDOKU_SAMPLES_DIR) + "/" + SAMPLE_FILES[sampleId]));
+
+		grid.writeLine(line);
+
+		CHECK(0 == memcmp(line, SAMPLE_PUZZLES[sampleId], sizeof(line)));
+	}
+}
+
+/**
+ * Every kernel supported by the CPU scans the units as the scalar one, valid grids or not
+ */
+static void testKernels()
+{
+	std::mt19937 random(1);
+	std::vector<const char *> puzzles(HARD_PUZZLES, HARD_PUZZLES + NROF_HARD_PUZZLES);
+
+	for (uint32_t gridId = 0; gridId < 1000; gridId++) {
+
+		uint16_t cells[NROF_ROWS][NROF_COLS];
+
+		if (gridId < puzzles.size()) {
+
+			CSudokuGrid grid;
+			grid.readLine(puzzles[gridId], NROF_ROWS * NROF_COLS);
+
+			for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+				for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+					cells[rowId][colId] = grid.getCandidates(rowId, colId);
+				}
+			}
+		}
+		else {
+
+			// Mostly single values, some of them repeated, a few cells with no candidate
+			for (uint32_t cellId = 0; cellId < NROF_ROWS * NROF_COLS; cellId++) {
+
+				const uint32_t draw = random() % 64;
+				cells[cellId / NROF_COLS][cellId % NROF_COLS] = (0 == draw) ? 0 : (draw < 40) ? (uint16_t)(1 << (random() % NROF_VALUES)) : (uint16_t)(random() & ALL_CANDIDATES);
+			}
+		}
+
+		unitScan_t expected;
+		CHECK(scanUnits(cells, expected, KERNEL_SCALAR));
+
+		for (int kernel = KERNEL_SCALAR + 1; kernel < NROF_KERNELS; kernel++) {
+
+			unitScan_t scan;
+
+			if (false == scanUnits(cells, scan, kernel)) {
+
+				CHECK(false == isKernelSupported(kernel));
+				continue;
+			}
+
+			CHECK(expected.valid == scan.valid);
+			CHECK(0 == memcmp(expected.rows, scan.rows, sizeof(scan.rows)));
+			CHECK(0 == memcmp(expected.cols, scan.cols, sizeof(scan.cols)));
+			CHECK(0 == memcmp(expected.boxes, scan.boxes, sizeof(scan.boxes)));
+		}
+	}
+}
+
+/**
+ * Solves a text of puzzles with the batch solver, returning its output
+ */
+static std::string solveBatch(const std::string &text, const bool lockstep, const uint32_t nrofThreads = 1)
+{
+	FILE *in = tempFile(text);
+	FILE *out = tmpfile();
+
+	CHECK(nullptr != in);
+	CHECK(nullptr != out);
+
+	if ((nullptr == in) || (nullptr == out)) {
+		return std::string();
+	}
+
+	// Read like the standard input
+	CSudokuBatch batch(ENGINE_BACKTRACK, nrofThreads, LOGIC_NONE, lockstep);
+	CHECK(0 == batch.run(in, out));
+
+	const std::string output = readFile(out);
+
+	fclose(in);
+	fclose(out);
+
+	return output;
+}
+
+/**
+ * A stream is parsed like a file: rows of a grid are gathered only when they hold exactly 9 cells, any
+ * other short line or grid cut short is one invalid record
+ */
+static void testCorpus()
+{
+	const std::string invalid = std::string(NROF_ROWS * NROF_COLS, '.') + "\n";
+
+	CHECK(solveBatch("1234567\n89\n", false) == invalid + invalid);
+	CHECK(solveBatch(".523..6..\n6...4...3\n12\n.523..6..\n", false) == invalid + invalid + invalid);
+	CHECK(solveBatch("\n \t\n", false).empty());
+
+	for (uint32_t sampleId = 0; sampleId < NROF_SAMPLE_PUZZLES - 1; sampleId++) {
+
+		FILE *sample = fopen((std::string(SUDOKU_SAMPLES_DIR) + "/" + SAMPLE_FILES[sampleId]).c_str(), "rb");
+		CHECK(nullptr != sample);
+
+		if (nullptr == sample) {
+			continue;
+		}
+
+		const std::string text = readFile(sample);
+		fclose(sample);
+
+		CHECK(solveBatch(text, false) == solveLine(SAMPLE_PUZZLES[sampleId]) + "\n");
+	}
+}
+
+/**
+ * Solves a text or an archive written in pieces of random sizes by another thread through a pipe (a
+ * temporary file on Windows), read by the corpus in chunks of 'readSize' bytes
+ */
+static std::string streamBatch(const std::string &text, const size_t readSize, const uint32_t seed)
+{
+#if defined(_WIN32)
+	(void)seed;
+	FILE *in = tempFile(text);
+	std::thread writer;
+#else
+	int fds[2];
+	CHECK(0 == pipe(fds));
+
+	FILE *in = fdopen(fds[0], "rb");
+
+	std::thread writer([&text, fds, seed]() {
+
+		std::mt19937 random(seed);
+
+		for (size_t pos = 0; pos < text.size(); ) {
+
+			const size_t size = std::min<size_t>(text.size() - pos, 1 + random() % 200);
+
+			if (size != (size_t)write(fds[1], text.data() + pos, size)) {
+				break;
+			}
+
+			pos += size;
+
+			if (0 == (random() % 8)) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+
+		close(fds[1]);
+	});
+#endif
+
+	FILE *out = tmpfile();
+	std::string output;
+
+	CHECK(nullptr != in);
+	CHECK(nullptr != out);
+
+	if ((nullptr != in) && (nullptr != out)) {
+
+		CSudokuCorpus corpus;
+		CSudokuBatch batch;
+
+		CHECK(corpus.stream(in, readSize));
+		CHECK(0 == batch.run(corpus, out));
+
+		output = readFile(out);
+	}
+
+	if (writer.joinable()) {
+		writer.join();
+	}
+
+	if (nullptr != in) {
+		fclose(in);
+	}
+
+	if (nullptr != out) {
+		fclose(out);
+	}
+
+	return output;
+}
+
+/**
+ * A stream fed in pieces is parsed like a whole file, lines and grids split between the chunks of the
+ * corpus included, and an archive is still recognised on the first chunk
+ */
+static void testStream()
+{
+	std::string text;
+
+	for (const char *puzzle : HARD_PUZZLES) {
+		text += std::string(puzzle, NROF_ROWS * NROF_COLS) + "\r\n";
+	}
+
+	for (uint32_t sampleId = 0; sampleId < NROF_SAMPLE_PUZZLES - 1; sampleId++) {
+
+		FILE *sample = fopen((std::string(SUDOKU_SAMPLES_DIR) + "/" + SAMPLE_FILES[sampleId]).c_str(), "rb");
+		CHECK(nullptr != sample);
+
+		if (nullptr != sample) {
+
+			text += "\n" + readFile(sample) + "\n12\n";
+			fclose(sample);
+		}
+	}
+
+	text += ".523..6..\n6...4...3";
+
+	const std::string expected = solveBatch(text, false);
+
+	for (const size_t readSize : { (size_t)1, (size_t)7, (size_t)81, (size_t)82, (size_t)1000 }) {
+		CHECK(streamBatch(text, readSize, (uint32_t)readSize) == expected);
+	}
+
+	FILE *file = tmpfile();
+	CHECK(nullptr != file);
+
+	if (nullptr == file) {
+		return;
+	}
+
+	CSudokuArchive archive;
+
+	CHECK(archive.create(file, ARCHIVE_PUZZLES));
+
+	for (const char *puzzle : HARD_PUZZLES) {
+		archive.write(puzzle);
+	}
+
+	CHECK(archive.close());
+
+	const std::string bytes = readFile(file);
+	fclose(file);
+
+	CHECK(streamBatch(bytes, 3, 1) == solveBatch(text.substr(0, NROF_HARD_PUZZLES * (NROF_ROWS * NROF_COLS + 2)), false));
+}
+
+/**
+ * The lockstep lanes give the same output as the grids, including invalid lines and conflicts
+ */
+static void testLockstep()
+{
+	std::string text;
+	std::string expected;
+
+	for (uint32_t round = 0; round < 3; round++) {
+
+		for (const char *puzzle : HARD_PUZZLES) {
+
+			text += std::string(puzzle, NROF_ROWS * NROF_COLS) + "\n";
+			expected += solveLine(puzzle) + "\n";
+		}
+
+		for (const char *puzzle : SAMPLE_PUZZLES) {
+
+			text += std::string(puzzle, NROF_ROWS * NROF_COLS) + "\n";
+			expected += solveLine(puzzle) + "\n";
+		}
+	}
+
+	// A line too short and a puzzle with a conflict
+	text += "123\n";
+	expected += std::string(NROF_ROWS * NROF_COLS, '.') + "\n";
+
+	std::string conflict(HARD_PUZZLES[0], NROF_ROWS * NROF_COLS);
+	conflict[1] = '1';
+	text += conflict + "\n";
+
+	const std::string plain = solveBatch(text, false);
+
+	CHECK(0 == plain.compare(0, expected.size(), expected));
+	CHECK(plain.size() == expected.size() + NROF_ROWS * NROF_COLS + 1);
+
+	CHECK(plain == solveBatch(text, true));
+	CHECK(plain == solveBatch(text, true, 3));
+	CHECK(plain == solveBatch(text, false, 3));
+}
+
+/**
+ * Puzzles and solved grids go through an archive unchanged, corrupted or truncated archives are refused
+ */
+static void testArchive()
+{
+	std::mt19937 random(2);
+	CSudokuSampler sampler(3);
+
+	for (uint32_t gridId = 0; gridId < 1000; gridId++) {
+
+		char solution[NROF_ROWS * NROF_COLS];
+		char puzzle[NROF_ROWS * NROF_COLS];
+		char line[NROF_ROWS * NROF_COLS];
+		uint8_t record[ARCHIVE_MAX_PUZZLE_SIZE];
+
+		sampler.sample(solution);
+
+		CHECK(CSudokuArchive::encodeSolution(solution, record));
+		CHECK(CSudokuArchive::decodeSolution(record, line));
+		CHECK(0 == memcmp(solution, line, sizeof(line)));
+
+		for (uint32_t cellId = 0; cellId < NROF_ROWS * NROF_COLS; cellId++) {
+			puzzle[cellId] = (0 == (random() % (1 + gridId % 4))) ? solution[cellId] : 46; // '.' = 46
+		}
+
+		const uint32_t size = CSudokuArchive::encodePuzzle(puzzle, record);
+
+		CHECK(size <= ARCHIVE_MAX_PUZZLE_SIZE);
+		CHECK(size == CSudokuArchive::decodePuzzle(record, size, line));
+		CHECK(0 == memcmp(puzzle, line, sizeof(line)));
+
+		// Cut short
+		CHECK((size <= ARCHIVE_MASK_SIZE) || (0 == CSudokuArchive::decodePuzzle(record, size - 1, line)));
+
+		// An incomplete grid is no solution
+		CHECK((0 == (gridId % 4)) || (false == CSudokuArchive::encodeSolution(puzzle, record)));
+	}
+
+	// Archive of the hard puzzles, read back through a corpus
+	FILE *file = tmpfile();
+	CHECK(nullptr != file);
+
+	if (nullptr == file) {
+		return;
+	}
+
+	CSudokuArchive archive;
+
+	CHECK(archive.create(file, ARCHIVE_PUZZLES));
+
+	for (const char *puzzle : HARD_PUZZLES) {
+		archive.write(puzzle);
+	}
+
+	CHECK(archive.close());
+
+	const std::string bytes = readFile(file);
+	fclose(file);
+
+	const char *cells;
+	CSudokuCorpus corpus;
+
+	file = tempFile(bytes);
+	CHECK(corpus.read(file));
+	fclose(file);
+
+	CHECK(corpus.isArchive());
+
+	for (const char *puzzle : HARD_PUZZLES) {
+		CHECK(corpus.next(cells) && (0 == memcmp(cells, puzzle, NROF_ROWS * NROF_COLS)));
+	}
+
+	CHECK(false == corpus.next(cells));
+	CHECK(corpus.isComplete());
+
+	// The same archive as a stream, solved like its text
+	std::string text;
+
+	for (const char *puzzle : HARD_PUZZLES) {
+		text += std::string(puzzle, NROF_ROWS * NROF_COLS) + "\n";
+	}
+
+	CHECK(solveBatch(bytes, false) == solveBatch(text, false));
+
+	// Not rated as text
+	std::istringstream in(bytes);
+	std::ostringstream out;
+	CSudokuRater rater;
+
+	CHECK(1 == rater.run(in, out));
+	CHECK(out.str().empty());
+
+	// A byte changed in a record
+	std::string corrupted = bytes;
+	corrupted[ARCHIVE_HEADER_SIZE + 5] ^= 0x10;
+
+	file = tempFile(corrupted);
+	CHECK(false == corpus.read(file));
+	fclose(file);
+
+	// Without its last byte
+	file = tempFile(bytes.substr(0, bytes.size() - 1));
+	CHECK(false == corpus.read(file));
+	fclose(file);
+
+	// Only the header
+	file = tempFile(bytes.substr(0, ARCHIVE_HEADER_SIZE));
+	CHECK(false == corpus.read(file));
+	fclose(file);
+}
+
+/**
+ * Equivalent puzzles have the same canonical form, which goes back to each of them
+ */
+static void testCanonical()
+{
+	std::mt19937 random(4);
+	CSudokuCanonical canonicalizer;
+
+	std::vector<const char *> puzzles(SAMPLE_PUZZLES, SAMPLE_PUZZLES + NROF_SAMPLE_PUZZLES);
+	puzzles.insert(puzzles.end(), HARD_PUZZLES, HARD_PUZZLES + NROF_HARD_PUZZLES);
+
+	for (const char *puzzle : puzzles) {
+
+		char canonical[NROF_ROWS * NROF_COLS];
+		transform_t transform;
+
+		CHECK(canonicalizer.canonicalize(puzzle, canonical, transform));
+
+		const std::string solution = solveLine(puzzle);
+
+		// Solution of the canonical form, as the cache holds it
+		char canonicalSolution[NROF_ROWS * NROF_COLS];
+		CSudokuCanonical::apply(transform, solution.data(), canonicalSolution);
+
+		CHECK(isSolution(canonicalSolution, canonical));
+
+		for (uint32_t round = 0; round < 20; round++) {
+
+			char transformed[NROF_ROWS * NROF_COLS];
+			char other[NROF_ROWS * NROF_COLS];
+			char line[NROF_ROWS * NROF_COLS];
+			transform_t otherTransform;
+
+			shuffleGrid(puzzle, transformed, random);
+
+			CHECK(canonicalizer.canonicalize(transformed, other, otherTransform));
+			CHECK(0 == memcmp(canonical, other, sizeof(other)));
+
+			CSudokuCanonical::revert(otherTransform, other, line);
+			CHECK(0 == memcmp(transformed, line, sizeof(line)));
+
+			CSudokuCanonical::revert(otherTransform, canonicalSolution, line);
+			CHECK(isSolution(line, transformed));
+		}
+	}
+
+	// Idempotent
+	char canonical[NROF_ROWS * NROF_COLS];
+	char again[NROF_ROWS * NROF_COLS];
+	transform_t transform;
+
+	CHECK(canonicalizer.canonicalize(HARD_PUZZLES[0], canonical, transform));
+	CHECK(canonicalizer.canonicalize(canonical, again, transform));
+	CHECK(0 == memcmp(canonical, again, sizeof(again)));
+}
+
+/**
+ * Puzzles 'first' to 'first + nrofPuzzles' of the sequence of a seed, one line each
+ */
+static std::string generateLines(const uint64_t seed, const uint64_t first, const uint64_t nrofPuzzles, const uint32_t nrofThreads, const uint8_t mask = MASK_LEVEL, const uint32_t nrofClues = 0)
+{
+	CSudokuGenerator generator(EASY, seed, nrofThreads, mask, nrofClues);
+	FILE *out = tmpfile();
+
+	if (nullptr == out) {
+		return std::string();
+	}
+
+	CHECK(0 == generator.run(first, nrofPuzzles, out));
+
+	const std::string text = readFile(out);
+	fclose(out);
+
+	return text;
+}
+
+/**
+ * Generated puzzles have a single solution and only depend on the seed and their number
+ */
+static void testGenerator()
+{
+	const uint64_t seed = 7;
+	const uint32_t nrofPuzzles = 6;
+	const size_t lineSize = NROF_ROWS * NROF_COLS + 1;
+
+	for (const uint8_t mask : { (uint8_t)MASK_LEVEL, (uint8_t)MASK_RANDOM, (uint8_t)MASK_SYMMETRIC }) {
+
+		const std::string text = generateLines(seed, 0, nrofPuzzles, 1, mask, 26);
+
+		CHECK(nrofPuzzles * lineSize == text.size());
+
+		for (size_t offset = 0; offset + lineSize <= text.size(); offset += lineSize) {
+
+			CSudokuGrid grid;
+
+			CHECK(10 == text[offset + lineSize - 1]); // '\n' = 10
+			CHECK(grid.readLine(text.data() + offset, NROF_ROWS * NROF_COLS));
+			CHECK(1 == grid.countSolutions(2));
+		}
+
+		// Same puzzles with any number of workers
+		CHECK(text == generateLines(seed, 0, nrofPuzzles, 3, mask, 26));
+
+		// Puzzle k of the sequence, whichever puzzle the run starts with
+		for (uint32_t k = 1; k < nrofPuzzles; k += 2) {
+			CHECK(0 == text.compare(k * lineSize, lineSize, generateLines(seed, k, 1, 1, mask, 26)));
+		}
+	}
+
+	// The generator of a puzzle only depends on the seed and the number of the puzzle
+	std::mt19937 random;
+	std::mt19937 again;
+
+	CSudokuGrid::seedRandom(random, seed, 3);
+	CSudokuGrid::seedRandom(again, seed, 3);
+	CHECK(random() == again());
+
+	CSudokuGrid::seedRandom(again, seed, 4);
+	CSudokuGrid::seedRandom(random, seed, 3);
+	CHECK(random() != again());
+
+	// Pattern-free puzzles keep the clues asked for (one less for a symmetric pair), with a single solution
+	for (const uint8_t mask : { (uint8_t)MASK_RANDOM, (uint8_t)MASK_SYMMETRIC }) {
+
+		CSudokuGrid grid;
+		char puzzle[NROF_ROWS * NROF_COLS];
+
+		CSudokuGrid::seedRandom(random, seed, 0);
+
+		const uint32_t nrofClues = grid.generateClues(30, mask, random);
+
+		CHECK((29 <= nrofClues) && (nrofClues <= 30));
+
+		grid.writeLine(puzzle);
+
+		uint32_t count = 0;
+
+		for (const char cell : puzzle) {
+			count += (46 != cell) ? 1 : 0; // '.' = 46
+		}
+
+		CHECK(nrofClues == count);
+
+		CSudokuGrid unique;
+		CHECK(unique.readLine(puzzle, NROF_ROWS * NROF_COLS));
+		CHECK(1 == unique.countSolutions(2));
+	}
+}
+
+/**
+ * Rating of a puzzle of the tests, its grid left solved
+ */
+static rating_t ratePuzzle(const char *puzzle)
+{
+	CSudokuRater rater;
+	CSudokuGrid grid;
+	rating_t rating = rating_t();
+	char solution[NROF_ROWS * NROF_COLS];
+
+	CHECK(grid.readLine(puzzle, NROF_ROWS * NROF_COLS));
+	CHECK(VALID_SOLVED == rater.rate(grid, rating));
+
+	grid.writeLine(solution);
+	CHECK(isSolution(solution, puzzle));
+
+	return rating;
+}
+
+/**
+ * Steps of each technique and the score they add up to, an easy puzzle scoring below a hard one
+ */
+static void testRater()
+{
+	const rating_t easy = ratePuzzle(SAMPLE_PUZZLES[EASY]);
+	const rating_t hard = ratePuzzle(HARD_PUZZLES[0]);
+
+	// The easy sample only takes singles
+	CHECK(easy.steps[TECH_NAKED_SINGLE] + easy.steps[TECH_HIDDEN_SINGLE] > 0);
+	CHECK(easy.hardest <= TECH_HIDDEN_SINGLE);
+	CHECK(0 == easy.steps[TECH_SEARCH]);
+
+	for (const rating_t &rating : { easy, hard }) {
+
+		uint32_t score = 0;
+
+		for (uint32_t technique = 0; technique < NROF_TECHNIQUES; technique++) {
+
+			score += TECH_WEIGHT[technique] * rating.steps[technique];
+
+			CHECK((0 == rating.steps[technique]) || (technique <= rating.hardest));
+		}
+
+		CHECK(rating.score == score);
+		CHECK(0 < rating.steps[rating.hardest]);
+	}
+
+	CHECK(hard.hardest > TECH_HIDDEN_SINGLE);
+	CHECK(easy.score < hard.score);
+
+	// Nothing is left to do on a solved grid
+	const std::string solution = solveLine(HARD_PUZZLES[0]);
+	const rating_t solved = ratePuzzle(solution.c_str());
+
+	CHECK(0 == solved.score);
+}
+
+/**
+ * Key of the cache test, 81 characters filled with 'id'
+ */
+static std::string cacheKey(const uint32_t id)
+{
+	return std::string(NROF_ROWS * NROF_COLS, (char)(48 + id)); // '0' = 48
+}
+
+/**
+ * Least recently used cache of the solutions, on its own and behind CSudokuGrid::solve
+ */
+static void testCache()
+{
+	char solution[NROF_ROWS * NROF_COLS];
+
+	// The least recently used puzzle is dropped, finding one makes it the most recently used
+	CSudokuCache cache(2);
+
+	cache.insert(cacheKey(1).data(), cacheKey(5).data());
+	cache.insert(cacheKey(2).data(), cacheKey(6).data());
+
+	CHECK(cache.find(cacheKey(1).data(), solution));
+	CHECK(0 == memcmp(solution, cacheKey(5).data(), sizeof(solution)));
+
+	cache.insert(cacheKey(3).data(), cacheKey(7).data());
+
+	CHECK(2 == cache.size());
+	CHECK(cache.find(cacheKey(1).data(), solution));
+	CHECK(false == cache.find(cacheKey(2).data(), solution));
+	CHECK(cache.find(cacheKey(3).data(), solution));
+	CHECK(0 == memcmp(solution, cacheKey(7).data(), sizeof(solution)));
+	CHECK(4 == cache.getLookups());
+	CHECK(3 == cache.getHits());
+
+	// Nothing is kept without capacity
+	CSudokuCache none(0);
+
+	none.insert(cacheKey(1).data(), cacheKey(5).data());
+
+	CHECK(0 == none.size());
+	CHECK(false == none.find(cacheKey(1).data(), solution));
+
+	// A puzzle equivalent to one solved before is solved by the cache
+	std::mt19937 random(5);
+	CSudokuCache solutions(16);
+
+	for (uint32_t puzzleId = 0; puzzleId < NROF_HARD_PUZZLES; puzzleId++) {
+
+		const char *puzzle = HARD_PUZZLES[puzzleId];
+		char transformed[NROF_ROWS * NROF_COLS];
+		searchStats_t stats;
+
+		CSudokuGrid grid;
+		grid.setCache(&solutions);
+
+		CHECK(grid.readLine(puzzle, NROF_ROWS * NROF_COLS));
+		CHECK(VALID_SOLVED == grid.solve(stats, false));
+
+		shuffleGrid(puzzle, transformed, random);
+
+		const uint64_t hits = solutions.getHits();
+
+		CSudokuGrid other;
+		other.setCache(&solutions);
+
+		CHECK(other.readLine(transformed, NROF_ROWS * NROF_COLS));
+		CHECK(VALID_SOLVED == other.solve(stats, false));
+		CHECK(hits + 1 == solutions.getHits());
+		CHECK(0 == stats.iter);
+
+		other.writeLine(solution);
+		CHECK(isSolution(solution, transformed));
+	}
+}
+
+/**
+ * Solves the boards of a size, checking their solutions
+ */
+template <uint32_t BOX>
+static void testBoards(const std::vector<const char *> &boards)
+{
+	CSudokuBoard<BOX> board;
+
+	for (const char *puzzle : boards) {
+
+		char solution[CSudokuBoard<BOX>::BOARD_CELLS];
+		searchStats_t stats;
+
+		CHECK(board.readLine(puzzle, CSudokuBoard<BOX>::BOARD_CELLS));
+		CHECK(1 == board.countSolutions(2));
+		CHECK(VALID_SOLVED == board.solve(stats));
+		CHECK(board.isSolved());
+
+		board.writeLine(solution);
+
+		CHECK(isSolution(solution, puzzle, BOX));
+	}
+}
+
+static void testBoard()
+{
+	testBoards<2>({ "1.3..4.2.1.343..", "12.....2..4..3.1" });
+	testBoards<4>(std::vector<const char *>(BOARD16_PUZZLES, BOARD16_PUZZLES + NROF_BOARD16_PUZZLES));
+}
+
+/**
+ * The generic solver of 9x9 boards agrees with CSudokuGrid, and its batch gives the same output on any number of threads
+ */
+static void testBoardGrid()
+{
+	CSudokuBoard<3> board;
+	std::string text;
+
+	for (const char *puzzle : HARD_PUZZLES) {
+
+		char solution[NROF_ROWS * NROF_COLS];
+		searchStats_t stats;
+		CSudokuGrid grid;
+
+		CHECK(board.readLine(puzzle, NROF_ROWS * NROF_COLS));
+		CHECK(grid.readLine(puzzle, NROF_ROWS * NROF_COLS));
+		CHECK(grid.countSolutions(2) == board.countSolutions(2));
+		CHECK(VALID_SOLVED == board.solve(stats));
+
+		board.writeLine(solution);
+
+		CHECK(std::string(solution, sizeof(solution)) == solveLine(puzzle));
+
+		text += std::string(puzzle, NROF_ROWS * NROF_COLS) + "\n";
+	}
+
+	// Invalid lines keep their place
+	text += "12\n";
+
+	std::istringstream in1(text), in3(text);
+	std::ostringstream out1, out3;
+
+	CHECK(0 == CSudokuBoard<3>::run(in1, out1, 1));
+	CHECK(0 == CSudokuBoard<3>::run(in3, out3, 3));
+	CHECK(out1.str() == out3.str());
+	CHECK(out1.str() == solveBatch(text, false));
+}
+
+/**
+ * Whether the five grids of a Samurai puzzle in line format are solved and keep the clues of the puzzle
+ */
+static bool isSamuraiSolution(const char *solution, const char *puzzle)
+{
+	static const uint32_t ORIGINS[SAMURAI_GRIDS][2] = { { 0, 0 }, { 0, 12 }, { 6, 6 }, { 12, 0 }, { 12, 12 } };
+
+	for (uint32_t gridId = 0; gridId < SAMURAI_GRIDS; gridId++) {
+
+		char grid[NROF_ROWS * NROF_COLS];
+		char clues[NROF_ROWS * NROF_COLS];
+
+		for (uint32_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+			const uint32_t position = (ORIGINS[gridId][0] + rowId) * SAMURAI_SIZE + ORIGINS[gridId][1];
+
+			memcpy(grid + rowId * NROF_COLS, solution + position, NROF_COLS);
+			memcpy(clues + rowId * NROF_COLS, puzzle + position, NROF_COLS);
+		}
+
+		if (false == isSolution(grid, clues)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void testSamurai()
+{
+	CSudokuSamurai samurai;
+	char solution[SAMURAI_SIZE * SAMURAI_SIZE];
+	searchStats_t stats;
+
+	CHECK(samurai.readLine(SAMURAI_PUZZLE, SAMURAI_SIZE * SAMURAI_SIZE));
+	CHECK(1 == samurai.countSolutions(2));
+	CHECK(VALID_SOLVED == samurai.solve(stats));
+
+	samurai.writeLine(solution);
+	CHECK(isSamuraiSolution(solution, SAMURAI_PUZZLE));
+
+	// Generated puzzles have a single solution, the same one for the same seed and number
+	for (uint64_t number = 0; number < 2; number++) {
+
+		char puzzle[SAMURAI_SIZE * SAMURAI_SIZE];
+		char again[SAMURAI_SIZE * SAMURAI_SIZE];
+
+		CHECK(0 != samurai.generate(5, number));
+		samurai.writeLine(puzzle);
+
+		CHECK(1 == samurai.countSolutions(2));
+		CHECK(VALID_SOLVED == samurai.solve(stats));
+
+		samurai.writeLine(solution);
+		CHECK(isSamuraiSolution(solution, puzzle));
+
+		samurai.generate(5, number);
+		samurai.writeLine(again);
+
+		CHECK(0 == memcmp(puzzle, again, sizeof(again)));
+	}
+}
+
+/**
+ * The Killer puzzle of the Debug folder is solved within its cages, and so is X-Sudoku
+ */
+static void testVariants()
+{
+	CSudokuConstraints constraints;
+	CSudokuGrid grid;
+
+	CHECK(constraints.read(std::string(SUDOKU_SAMPLES_DIR) + "/killer.var"));
+
+	grid.setConstraints(&constraints);
+
+	CHECK(grid.readGrid(std::string(SUDOKU_SAMPLES_DIR) + "/killer.txt"));
+
+	char puzzle[NROF_ROWS * NROF_COLS];
+	char solution[NROF_ROWS * NROF_COLS];
+	searchStats_t stats;
+
+	grid.writeLine(puzzle);
+
+	CHECK(1 == grid.countSolutions(2));
+	CHECK(VALID_SOLVED == grid.solve(stats, false));
+
+	grid.writeLine(solution);
+
+	CHECK(isSolution(solution, puzzle));
+
+	uint16_t cells[NROF_ROWS][NROF_COLS];
+
+	for (uint16_t rowId = 0; rowId < NROF_ROWS; rowId++) {
+
+		for (uint16_t colId = 0; colId < NROF_COLS; colId++) {
+			cells[rowId][colId] = grid.getCandidates(rowId, colId);
+		}
+	}
+
+	CHECK(constraints.isValid(cells));
+
+	// The cages add up to their sums
+	for (uint32_t constraintId = 0; constraintId < constraints.size(); constraintId++) {
+
+		const constraint_t &constraint = constraints.get(constraintId);
+		uint32_t sum = 0;
+
+		for (const uint8_t cellId : constraint.cells) {
+			sum += solution[cellId] - 48; // '0' = 48
+		}
+
+		CHECK((CONSTRAINT_CAGE != constraint.type) || (constraint.sum == sum));
+	}
+
+	// X-Sudoku: both diagonals hold every value
+	CSudokuConstraints diagonals;
+	diagonals.addDiagonals();
+
+	CSudokuGrid xGrid;
+	xGrid.setConstraints(&diagonals);
+	xGrid.readLine(std::string(NROF_ROWS * NROF_COLS, '.').data(), NROF_ROWS * NROF_COLS);
+
+	CHECK(VALID_SOLVED == xGrid.solve(stats, false));
+
+	xGrid.writeLine(solution);
+
+	CHECK(isSolution(solution, solution));
+	CHECK(isUnitValid(solution, NROF_VALUES, 0, NROF_COLS + 1, NROF_VALUES, 0));
+	CHECK(isUnitValid(solution, NROF_VALUES, NROF_COLS - 1, NROF_COLS - 1, NROF_VALUES, 0));
+}
+
+// Tests run by name, all of them when none is given
+typedef struct {
+	const char *name;
+	void (*run)();
+} test_t;
+
+static const test_t TESTS[] = {
+	{ "solve", testSolve },
+	{ "samples", testSampleFiles },
+	{ "kernels", testKernels },
+	{ "corpus", testCorpus },
+	{ "stream", testStream },
+	{ "lockstep", testLockstep },
+	{ "archive", testArchive },
+	{ "canonical", testCanonical },
+	{ "cache", testCache },
+	{ "generator", testGenerator },
+	{ "rater", testRater },
+	{ "board", testBoard },
+	{ "board-grid", testBoardGrid },
+	{ "samurai", testSamurai },
+	{ "variants", testVariants }
+};
+
+int main(int argc, char *argv[])
+{
+	const std::string name = (argc > 1) ? argv[1] : "";
+	bool found = false;
+
+	for (const test_t &test : TESTS) {
+
+		if ((false == name.empty()) && (name != test.name)) {
+			continue;
+		}
+
+		found = true;
+		g_nrofFailures = 0;
+
+		test.run();
+
+		std::cout << test.name << ": " << ((0 == g_nrofFailures) ? "passed" : "FAILED") << std::endl;
+
+		if (g_nrofFailures) {
+			return 1;
+		}
+	}
+
+	if (false == found) {
+
+		std::cerr << "Unknown test " << name << std::endl;
+		return 1;
+	}
+
+	return 0;
+}